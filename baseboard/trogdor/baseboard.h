@@ -43,7 +43,6 @@
 
 #define CONFIG_HOSTCMD_SPS
 #define CONFIG_HOST_COMMAND_STATUS
-#define CONFIG_HOSTCMD_SECTION_SORTED
 #define CONFIG_MKBP_EVENT
 #define CONFIG_KEYBOARD_PROTOCOL_MKBP
 #define CONFIG_KEYBOARD_COL2_INVERTED
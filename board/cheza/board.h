@@ -52,7 +52,6 @@
 
 #define CONFIG_HOSTCMD_SPS
 #define CONFIG_HOST_COMMAND_STATUS
-#define CONFIG_HOSTCMD_SECTION_SORTED /* Host commands are sorted. */
 #define CONFIG_MKBP_EVENT
 #define CONFIG_KEYBOARD_PROTOCOL_MKBP
 #define CONFIG_MKBP_USE_GPIO
@@ -13,10 +13,18 @@
 #include "persistence.h"
 #include "util.h"
 
-/* This needs to be aligned to the erase bank size for NVCTR. */
-__aligned(CONFIG_FLASH_ERASE_SIZE) char __host_flash[CONFIG_FLASH_SIZE];
+/*
+ * This needs to be aligned to the erase bank size for NVCTR, and to the page
+ * size so that it can be mapped onto the persistent storage.
+ */
+#define HOST_FLASH_ALIGN 4096
+BUILD_ASSERT(HOST_FLASH_ALIGN % CONFIG_FLASH_ERASE_SIZE == 0);
+__aligned(HOST_FLASH_ALIGN) char __host_flash[CONFIG_FLASH_SIZE];
 uint8_t __host_flash_protect[PHYSICAL_BANKS];
 
+/* Set when __host_flash is a shared mapping of the persistent storage */
+static int flash_mapped;
+
 /* Override this function to make flash erase/write operation fail */
 test_mockable int flash_pre_op(void)
 {
@@ -36,11 +44,18 @@ static int flash_check_protect(int offset, int size)
 	return 0;
 }
 
-static void flash_set_persistent(void)
+static void flash_set_persistent(int offset, int size)
 {
-	FILE *f = get_persistent_storage("flash", "wb");
+	FILE *f;
 	int sz;
 
+	/* A mapped image already holds the change, just write it back */
+	if (flash_mapped) {
+		sync_persistent_storage(__host_flash + offset, size);
+		return;
+	}
+
+	f = get_persistent_storage("flash", "wb");
 	ASSERT(f != NULL);
 
 	sz = fwrite(__host_flash, sizeof(__host_flash), 1, f);
@@ -51,8 +66,26 @@ static void flash_set_persistent(void)
 
 static void flash_get_persistent(void)
 {
-	FILE *f = get_persistent_storage("flash", "rb");
+	FILE *f;
+	int rv;
+
+	/*
+	 * Prefer mapping the image, so writes only touch the pages they
+	 * change instead of rewriting the whole file.  Fall back to reading
+	 * a private copy if that is not possible.
+	 */
+	rv = map_persistent_storage("flash", __host_flash, sizeof(__host_flash));
+	if (rv >= 0) {
+		flash_mapped = 1;
+		if (rv) {
+			fprintf(stderr, "No flash storage found. "
+				"Initializing to 0xff.\n");
+			memset(__host_flash, 0xff, sizeof(__host_flash));
+		}
+		return;
+	}
 
+	f = get_persistent_storage("flash", "rb");
 	if (f == NULL) {
 		fprintf(stderr,
 			"No flash storage found. Initializing to 0xff.\n");
@@ -76,7 +109,7 @@ int flash_physical_write(int offset, int size, const char *data)
 		return EC_ERROR_ACCESS_DENIED;
 
 	memcpy(__host_flash + offset, data, size);
-	flash_set_persistent();
+	flash_set_persistent(offset, size);
 
 	return EC_SUCCESS;
 }
@@ -92,7 +125,7 @@ int flash_physical_erase(int offset, int size)
 		return EC_ERROR_ACCESS_DENIED;
 
 	memset(__host_flash + offset, 0xff, size);
-	flash_set_persistent();
+	flash_set_persistent(offset, size);
 
 	return EC_SUCCESS;
 }
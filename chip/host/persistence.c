@@ -5,11 +5,17 @@
 
 /* Persistence module for emulator */
 
+#include <fcntl.h>
 #include <linux/limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "persistence.h"
+
 static void get_storage_path(char *out)
 {
 	char buf[PATH_MAX];
@@ -30,10 +36,9 @@ static void get_storage_path(char *out)
 	out[PATH_MAX - 1] = '\0';
 }
 
-FILE *get_persistent_storage(const char *tag, const char *mode)
+static void get_tag_path(const char *tag, char *path)
 {
 	char buf[PATH_MAX];
-	char path[PATH_MAX];
 
 	/*
 	 * The persistent storage with tag 'foo' for test 'bar' would
@@ -42,6 +47,13 @@ FILE *get_persistent_storage(const char *tag, const char *mode)
 	get_storage_path(buf);
 	snprintf(path, PATH_MAX - 1, "%s_%s", buf, tag);
 	path[PATH_MAX - 1] = '\0';
+}
+
+FILE *get_persistent_storage(const char *tag, const char *mode)
+{
+	char path[PATH_MAX];
+
+	get_tag_path(tag, path);
 
 	return fopen(path, mode);
 }
@@ -53,12 +65,59 @@ void release_persistent_storage(FILE *ps)
 
 void remove_persistent_storage(const char *tag)
 {
-	char buf[PATH_MAX];
 	char path[PATH_MAX];
 
-	get_storage_path(buf);
-	snprintf(path, PATH_MAX - 1, "%s_%s", buf, tag);
-	path[PATH_MAX - 1] = '\0';
+	get_tag_path(tag, path);
 
 	unlink(path);
 }
+
+int map_persistent_storage(const char *tag, void *addr, size_t size)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	void *map;
+	int created;
+	int fd;
+
+	if ((uintptr_t)addr % sysconf(_SC_PAGESIZE) ||
+	    size % sysconf(_SC_PAGESIZE))
+		return -1;
+
+	get_tag_path(tag, path);
+
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0)
+		return -1;
+
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	/* Anything short of a full image is treated as a new one */
+	created = st.st_size != size;
+	if (created && ftruncate(fd, size) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	/* Replace the pages at addr with a shared view of the file */
+	map = mmap(addr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+		   fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return -1;
+
+	return created;
+}
+
+void sync_persistent_storage(void *addr, size_t size)
+{
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t start = (uintptr_t)addr & ~(page - 1);
+	uintptr_t end = ((uintptr_t)addr + size + page - 1) & ~(page - 1);
+
+	/* Only schedule the write back, the page cache is already coherent */
+	msync((void *)start, end - start, MS_ASYNC);
+}
@@ -8,6 +8,7 @@
 #ifndef __CROS_EC_PERSISTENCE_H
 #define __CROS_EC_PERSISTENCE_H
 
+#include <stddef.h>
 #include <stdio.h>
 
 #ifdef __cplusplus
@@ -20,6 +21,27 @@ void release_persistent_storage(FILE *ps);
 
 void remove_persistent_storage(const char *tag);
 
+/**
+ * Back a memory region with the persistent storage for a tag.
+ *
+ * The pages at addr are replaced by a shared mapping of the storage file, so
+ * stores to the region go to the file without having to write it out again.
+ * The file is created, or resized and zero-filled, if it does not hold
+ * exactly size bytes.
+ *
+ * @param tag		Storage tag
+ * @param addr		Page-aligned start of the region
+ * @param size		Size of the region, a multiple of the page size
+ * @return 1 if the storage is new, 0 if it was already there, or -1 if the
+ *	   region could not be mapped and is unchanged.
+ */
+int map_persistent_storage(const char *tag, void *addr, size_t size);
+
+/**
+ * Schedule write back of part of a region set up by map_persistent_storage().
+ */
+void sync_persistent_storage(void *addr, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
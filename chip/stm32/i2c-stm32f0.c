@@ -225,6 +225,31 @@ static int tx_pending;
 static int tx_index, tx_end;
 static struct host_packet i2c_packet;
 
+/*
+ * Bytes of the response in host_buffer.  Any response data segments from
+ * the host command follow these.
+ */
+static int tx_buf_end;
+static const struct host_response_iov *tx_iov;
+static int tx_iov_count;
+
+static uint8_t i2c_tx_byte(int index)
+{
+	int i;
+
+	if (index < tx_buf_end)
+		return host_buffer[index];
+
+	index -= tx_buf_end;
+	for (i = 0; i < tx_iov_count; i++) {
+		if (index < tx_iov[i].size)
+			return ((const uint8_t *)tx_iov[i].data)[index];
+		index -= tx_iov[i].size;
+	}
+
+	return 0xec;
+}
+
 static void i2c_send_response_packet(struct host_packet *pkt)
 {
 	int size = pkt->response_size;
@@ -242,6 +267,12 @@ static void i2c_send_response_packet(struct host_packet *pkt)
 	tx_index = 0;
 	tx_end = size + 2;
 
+	/* Response data segments are sent from where they are */
+	tx_iov = pkt->response_iov;
+	tx_iov_count = pkt->response_iov_count;
+	tx_buf_end = tx_iov_count ? 2 + sizeof(struct ec_host_response) :
+		tx_end;
+
 	/*
 	 * Set the transmitter to be in 'not full' state to keep sending
 	 * '0xec' in the event loop. Because of this, the master i2c
@@ -278,6 +309,7 @@ static void i2c_process_command(void)
 	i2c_packet.response = (void *)(&buff[2]);
 	i2c_packet.response_max = I2C_MAX_HOST_PACKET_SIZE;
 	i2c_packet.response_size = 0;
+	i2c_packet.response_iov_ok = 1;
 
 	if (*buff >= EC_COMMAND_PROTOCOL_3) {
 		i2c_packet.driver_result = EC_RES_SUCCESS;
@@ -294,6 +326,8 @@ static void i2c_send_tcpc_response(int len)
 	/* host_buffer data range, beyond this length, will return 0xec */
 	tx_index = 0;
 	tx_end = len;
+	tx_buf_end = len;
+	tx_iov_count = 0;
 
 	/* enable transmit interrupt and use irq to send data back */
 	STM32_I2C_CR1(host_i2c_resp_port) |= STM32_I2C_CR1_TXIE;
@@ -400,7 +434,7 @@ static void i2c_event_handler(int port)
 			if (tx_pending) {
 				if (tx_index < tx_end) {
 					STM32_I2C_TXDR(port) =
-						host_buffer[tx_index++];
+						i2c_tx_byte(tx_index++);
 				} else {
 					STM32_I2C_TXDR(port) = 0xec;
 					/*
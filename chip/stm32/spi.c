@@ -540,7 +540,11 @@ void spi_event(enum gpio_signal signal)
 		spi_packet.request_max = sizeof(in_msg);
 		spi_packet.request_size = pkt_size;
 
-		/* Response must start with the preamble */
+		/*
+		 * Response must start with the preamble.  Response data
+		 * segments are copied in too (no response_iov_ok), since the
+		 * whole response goes out as one DMA transfer.
+		 */
 		memcpy(out_msg, out_preamble, sizeof(out_preamble));
 		spi_packet.response = out_msg + sizeof(out_preamble);
 		/* Reserve space for the preamble and trailing past-end byte */
@@ -102,9 +102,23 @@ int uart_tx_ready(void)
 
 #ifdef CONFIG_UART_TX_DMA
 
+/* Second span of a wrapped transfer, sent when the first is done */
+static const char *dma_tx_next;
+static int dma_tx_next_len;
+
 int uart_tx_dma_ready(void)
 {
-	return STM32_USART_SR(UARTN_BASE) & STM32_USART_SR_TC;
+	if (!(STM32_USART_SR(UARTN_BASE) & STM32_USART_SR_TC))
+		return 0;
+
+	/* The first span is done, start the second one straight away */
+	if (dma_tx_next_len) {
+		uart_tx_dma_start(dma_tx_next, dma_tx_next_len);
+		dma_tx_next_len = 0;
+		return 0;
+	}
+
+	return 1;
 }
 
 void uart_tx_dma_start(const char *src, int len)
@@ -122,6 +136,16 @@ void uart_tx_dma_start(const char *src, int len)
 	dma_go(dma_get_channel(dma_tx_option.channel));
 }
 
+int uart_tx_dma_start_spans(const char *src, int len,
+			    const char *next, int next_len)
+{
+	dma_tx_next = next;
+	dma_tx_next_len = next_len;
+	uart_tx_dma_start(src, len);
+
+	return len + next_len;
+}
+
 #endif /* CONFIG_UART_TX_DMA */
 
 int uart_rx_available(void)
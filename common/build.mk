@@ -10,7 +10,7 @@
 _common_dir:=$(dir $(lastword $(MAKEFILE_LIST)))
 
 common-y=util.o
-common-y+=version.o printf.o queue.o queue_policies.o
+common-y+=version.o printf.o queue.o queue_policies.o deadline_heap.o
 
 common-$(CONFIG_ACCELGYRO_BMI160)+=math_util.o
 common-$(CONFIG_ACCELGYRO_BMI260)+=math_util.o
@@ -179,7 +179,7 @@ common-$(CONFIG_AUDIO_CODEC_WOV)+=hotword_dsp_api.o
 endif
 
 ifneq ($(CONFIG_COMMON_RUNTIME),)
-common-$(CONFIG_MALLOC)+=shmalloc.o
+common-$(CONFIG_MALLOC)+=$(if $(CONFIG_MALLOC_SIZE_CLASSES),shmalloc_classes.o,shmalloc.o)
 common-$(call not_cfg,$(CONFIG_MALLOC))+=shared_mem.o
 endif
 
@@ -115,6 +115,49 @@ static int split_words(char *input, int *argc, char **argv)
 	return EC_SUCCESS;
 }
 
+/**
+ * Find the commands whose names start with a prefix.
+ *
+ * The linker sorts commands by name (see the .rodata.cmds sections in the
+ * linker scripts), and names are lower case, so the matches are contiguous
+ * and can be found with two binary searches.
+ *
+ * @param prefix	Prefix to look for; case-insensitive.
+ * @param len		Length of prefix.
+ * @param end		Destination for the end of the matching range.
+ *
+ * @return The first matching command, which is equal to *end if none match.
+ */
+static const struct console_command *find_command_range(
+	const char *prefix, int len, const struct console_command **end)
+{
+	const struct console_command *lo = __cmds, *hi = __cmds_end, *mid;
+	const struct console_command *first;
+
+	/* First command which doesn't sort before the prefix */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strncasecmp(mid->name, prefix, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	first = lo;
+
+	/* First command past the ones starting with the prefix */
+	hi = __cmds_end;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (strncasecmp(mid->name, prefix, len) > 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	*end = lo;
+
+	return first;
+}
+
 /**
  * Find a command by name.
  *
@@ -128,26 +171,22 @@ static int split_words(char *input, int *argc, char **argv)
  */
 static const struct console_command *find_command(char *name)
 {
-	const struct console_command *cmd, *match = NULL;
+	const struct console_command *cmd, *end;
 	int match_length = strlen(name);
 
-	for (cmd = __cmds; cmd < __cmds_end; cmd++) {
-		if (!strncasecmp(name, cmd->name, match_length)) {
-			if (match)
-				return NULL;
-			/*
-			 * Check if 'cmd->name' is of the same length as
-			 * 'name'. If yes, then we have a full match.
-			 */
-			if (cmd->name[match_length] == '\0')
-				return cmd;
-			match = cmd;
-		}
-	}
+	cmd = find_command_range(name, match_length, &end);
+	if (cmd == end)
+		return NULL;
 
-	return match;
-}
+	/*
+	 * A full match sorts ahead of the longer names it is a prefix of,
+	 * and wins over them.
+	 */
+	if (cmd->name[match_length] == '\0')
+		return cmd;
 
+	return end - cmd == 1 ? cmd : NULL;
+}
 
 static const char *const errmsgs[] = {
 	"OK",
@@ -365,6 +404,65 @@ static void save_history(void)
 
 #endif /* CONFIG_CONSOLE_HISTORY */
 
+#ifdef CONFIG_CONSOLE_TAB_COMPLETION
+/**
+ * Complete the command name being typed.
+ *
+ * Extends the input to the longest prefix shared by all commands it matches.
+ * If that doesn't add anything and several commands match, lists them and
+ * reprints the line.
+ */
+static void handle_tab(void)
+{
+	const struct console_command *first, *last, *cmd;
+	int len, i;
+
+	/* Only the command name is completed, with the cursor at its end */
+	if (input_pos != input_len)
+		return;
+	for (i = 0; i < input_len; i++) {
+		if (isspace(input_buf[i]))
+			return;
+	}
+
+	first = find_command_range(input_buf, input_len, &last);
+	if (first == last)
+		return;
+	last--;
+
+	/* Commands are sorted, so the first and last share the least */
+	len = input_len;
+	while (first->name[len] &&
+	       tolower(first->name[len]) == tolower(last->name[len]))
+		len++;
+
+	/* Complete no more than fits in the line */
+	len = MIN(len, (int)sizeof(input_buf) - 1);
+
+	if (first != last && len == input_len) {
+		/* Nothing to add; show the candidates */
+		ccputs("\n");
+		for (cmd = first; cmd <= last; cmd++)
+			ccprintf(" %s", cmd->name);
+		ccputs("\n" PROMPT);
+		ccputs(input_buf);
+		return;
+	}
+
+	strzcpy(input_buf + input_len, first->name + input_len,
+		len - input_len + 1);
+	if (first == last && !first->name[len] &&
+	    len < sizeof(input_buf) - 1) {
+		/* Unique match; add a space to start the arguments */
+		input_buf[len++] = ' ';
+		input_buf[len] = '\0';
+	}
+
+	ccputs(input_buf + input_len);
+	input_pos = input_len = len;
+}
+#endif /* CONFIG_CONSOLE_TAB_COMPLETION */
+
 #ifndef CONFIG_EXPERIMENTAL_CONSOLE
 static void handle_backspace(void)
 {
@@ -572,6 +670,12 @@ static void console_handle_char(int c)
 		input_buf[input_len] = '\0';
 		break;
 
+#ifdef CONFIG_CONSOLE_TAB_COMPLETION
+	case '\t':
+		handle_tab();
+		break;
+#endif
+
 	case CTRL('L'):
 		/* Reprint current */
 		ccputs("\x0c" PROMPT);
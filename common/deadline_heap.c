@@ -0,0 +1,60 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Min-heap of IDs ordered by deadline */
+
+#include "deadline_heap.h"
+
+static inline int deadline_before(const struct deadline_heap *h, int a, int b)
+{
+	return h->deadline[a].val < h->deadline[b].val;
+}
+
+static inline void deadline_heap_place(struct deadline_heap *h, int i, int id)
+{
+	h->heap[i] = id;
+	h->pos[id] = i + 1;
+}
+
+/* Move the ID at index i up or down to where its deadline belongs */
+static void deadline_heap_sift(struct deadline_heap *h, int i)
+{
+	int id = h->heap[i];
+	int child;
+
+	while (i > 0 && deadline_before(h, id, h->heap[(i - 1) / 2])) {
+		deadline_heap_place(h, i, h->heap[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+
+	while ((child = 2 * i + 1) < h->size) {
+		if (child + 1 < h->size &&
+		    deadline_before(h, h->heap[child + 1], h->heap[child]))
+			child++;
+		if (!deadline_before(h, h->heap[child], id))
+			break;
+		deadline_heap_place(h, i, h->heap[child]);
+		i = child;
+	}
+
+	deadline_heap_place(h, i, id);
+}
+
+void deadline_heap_insert(struct deadline_heap *h, int id)
+{
+	h->heap[h->size++] = id;
+	deadline_heap_sift(h, h->size - 1);
+}
+
+void deadline_heap_remove(struct deadline_heap *h, int id)
+{
+	int i = h->pos[id] - 1;
+
+	h->pos[id] = 0;
+	if (--h->size > i) {
+		h->heap[i] = h->heap[h->size];
+		deadline_heap_sift(h, i);
+	}
+}
@@ -293,6 +293,7 @@ static int flash_write_pstate_data(struct persist_state *newpstate)
 	int rv;
 
 	/* Erase pstate */
+	vboot_hash_cache_invalidate(CONFIG_FW_PSTATE_OFF, CONFIG_FW_PSTATE_SIZE);
 	rv = flash_physical_erase(CONFIG_FW_PSTATE_OFF,
 				  CONFIG_FW_PSTATE_SIZE);
 	if (rv)
@@ -554,6 +555,9 @@ static int flash_write_pstate(uint32_t flags)
 	 * Write a new pstate.  We can overwrite the existing value, because
 	 * we're only moving bits from the erased state to the unerased state.
 	 */
+	vboot_hash_cache_invalidate(get_pstate_addr() -
+				    CONFIG_PROGRAM_MEMORY_BASE,
+				    sizeof(new_pstate));
 	return flash_physical_write(get_pstate_addr() -
 				    CONFIG_PROGRAM_MEMORY_BASE,
 				    sizeof(new_pstate),
@@ -625,6 +629,9 @@ int flash_read(int offset, int size, char *data)
 
 static void flash_abort_or_invalidate_hash(int offset, int size)
 {
+	/* Whatever happens to the hash, the cached states are now stale */
+	vboot_hash_cache_invalidate(offset, size);
+
 #ifdef CONFIG_VBOOT_HASH
 	if (vboot_hash_in_progress()) {
 		/* Abort hash calculation when flash update is in progress. */
@@ -1324,12 +1331,25 @@ static enum ec_status flash_command_read(struct host_cmd_handler_args *args)
 	if (p->size > args->response_max)
 		return EC_RES_OVERFLOW;
 
+#if defined(CONFIG_MAPPED_STORAGE) && !defined(CONFIG_EXTERNAL_STORAGE)
+	{
+		const char *src;
+
+		/* Mapped flash needs no locking, so send straight from it */
+		if (flash_dataptr(offset, p->size, 1, &src) < 0)
+			return EC_RES_ERROR;
+
+		host_response_add_iov(args, src, p->size);
+		return EC_RES_SUCCESS;
+	}
+#else
 	if (flash_read(offset, p->size, args->response))
 		return EC_RES_ERROR;
 
 	args->response_size = p->size;
 
 	return EC_RES_SUCCESS;
+#endif
 }
 DECLARE_HOST_COMMAND(EC_CMD_FLASH_READ,
 		     flash_command_read,
@@ -368,7 +368,6 @@ static int validate_fp_buffer_offset(const uint32_t buffer_size,
 static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 {
 	const struct ec_params_fp_frame *params = args->params;
-	void *out = args->response;
 	uint32_t idx = FP_FRAME_GET_BUFFER_INDEX(params->offset);
 	uint32_t offset = params->offset & FP_FRAME_OFFSET_MASK;
 	uint32_t size = params->size;
@@ -392,8 +391,8 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 		if (ret != EC_SUCCESS)
 			return EC_RES_INVALID_PARAM;
 
-		memcpy(out, fp_buffer + offset, size);
-		args->response_size = size;
+		/* Send straight from the frame buffer */
+		host_response_add_iov(args, fp_buffer + offset, size);
 		return EC_RES_SUCCESS;
 	}
 
@@ -480,8 +479,7 @@ static enum ec_status fp_command_frame(struct host_cmd_handler_args *args)
 		}
 		templ_dirty &= ~BIT(fgr);
 	}
-	memcpy(out, fp_enc_buffer + offset, size);
-	args->response_size = size;
+	host_response_add_iov(args, fp_enc_buffer + offset, size);
 
 	return EC_RES_SUCCESS;
 }
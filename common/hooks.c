@@ -78,6 +78,26 @@ static uint64_t avg_hook_tick_delay;
 static uint64_t avg_hook_second_delay;
 static uint64_t avg_hook_run_time[ARRAY_SIZE(hook_list)];
 
+/* Histogram of how late deferred functions are called, by upper bound */
+static const uint32_t deferred_latency_limit[] = {
+	10, 100, MSEC, 10 * MSEC, 100 * MSEC
+};
+static uint32_t deferred_latency_count[ARRAY_SIZE(deferred_latency_limit) + 1];
+static uint64_t max_deferred_latency;
+
+static void record_deferred_latency(uint64_t latency)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(deferred_latency_limit); i++)
+		if (latency < deferred_latency_limit[i])
+			break;
+	deferred_latency_count[i]++;
+
+	if (latency > max_deferred_latency)
+		max_deferred_latency = latency;
+}
+
 static inline void update_hook_average(uint64_t *avg, uint64_t time)
 {
 	*avg = (*avg * 7 + time) >> 3;
@@ -102,11 +122,152 @@ static void record_hook_delay(uint64_t now, uint64_t last, uint64_t interval,
 }
 #endif
 
+/*
+ * Pending deferred calls are kept in a list sorted by firing time, linked
+ * through __deferred_next[].  A link is the next function's index plus one,
+ * DEFERRED_LIST_END after the last one, or 0 for a function not on the list.
+ *
+ * Only the hook task touches the list.  hook_call_deferred() can be called
+ * from any context, so it just updates __deferred_until[] and flags the
+ * function in __deferred_changed[].  The hook task then moves flagged
+ * functions to their new place in the list.
+ */
+#define DEFERRED_LIST_END 0xffff
+static uint16_t deferred_head = DEFERRED_LIST_END;
+
+static void deferred_list_insert(int i)
+{
+	uint16_t *link = &deferred_head;
+
+	while (*link != DEFERRED_LIST_END &&
+	       __deferred_until[*link - 1] <= __deferred_until[i])
+		link = &__deferred_next[*link - 1];
+
+	__deferred_next[i] = *link;
+	*link = i + 1;
+}
+
+static void deferred_list_remove(int i)
+{
+	uint16_t *link = &deferred_head;
+
+	while (*link != i + 1)
+		link = &__deferred_next[*link - 1];
+
+	*link = __deferred_next[i];
+	__deferred_next[i] = 0;
+}
+
+/**
+ * Move flagged deferred functions to their place in the list.
+ *
+ * All of them are taken off the list before any is put back, so the ones
+ * being put back are compared with up-to-date firing times only.
+ *
+ * @return non-zero if any function was flagged.
+ */
+static int deferred_list_update(void)
+{
+	uint16_t moved = DEFERRED_LIST_END;
+	uint32_t bits;
+	int changed = 0;
+	int w, i;
+
+	for (w = 0; w * 32 < DEFERRED_FUNCS_COUNT; w++) {
+		bits = atomic_read_clear(&__deferred_changed[w]);
+		changed |= bits;
+
+		while (bits) {
+			i = w * 32 + __fls(bits);
+			bits &= ~BIT(i % 32);
+
+			if (__deferred_next[i])
+				deferred_list_remove(i);
+			__deferred_next[i] = moved;
+			moved = i + 1;
+		}
+	}
+
+	while (moved != DEFERRED_LIST_END) {
+		i = moved - 1;
+		moved = __deferred_next[i];
+		__deferred_next[i] = 0;
+		if (__deferred_until[i])
+			deferred_list_insert(i);
+	}
+
+	return changed;
+}
+
+/**
+ * Bring the deferred list up to date with __deferred_until[].
+ *
+ * A function already on the list may be re-armed while others are being put
+ * back, so they may have landed out of order behind it.  That's rare, so
+ * just re-sort the whole list when it happens.
+ */
+static void deferred_list_sync(void)
+{
+	uint16_t pending;
+	int i;
+
+	if (!deferred_list_update())
+		return;
+
+	while (deferred_list_update()) {
+		pending = deferred_head;
+		deferred_head = DEFERRED_LIST_END;
+		while (pending != DEFERRED_LIST_END) {
+			i = pending - 1;
+			pending = __deferred_next[i];
+			deferred_list_insert(i);
+		}
+	}
+}
+
+/**
+ * Return the priority-sorted list for a hook type.
+ *
+ * __hooks_sorted has one slot per hook data entry, so each type's sorted list
+ * lives at the same offset in it as the type's hooks do from __hooks_init.
+ */
+static const struct hook_data **hook_sorted_list(enum hook_type type)
+{
+	return __hooks_sorted + (hook_list[type].start - __hooks_init);
+}
+
+/**
+ * Sort the hooks of each type by priority.
+ *
+ * Hooks of equal priority keep their link order.
+ */
+void hook_init(void)
+{
+	const struct hook_data **sorted;
+	const struct hook_data *p;
+	int type, i;
+
+	for (type = 0; type < ARRAY_SIZE(hook_list); type++) {
+		sorted = hook_sorted_list(type);
+
+		/* Insertion sort; stable, and each list is short */
+		for (p = hook_list[type].start, i = 0;
+		     p < hook_list[type].end; p++, i++) {
+			int j = i;
+
+			while (j > 0 && sorted[j - 1]->priority > p->priority) {
+				sorted[j] = sorted[j - 1];
+				j--;
+			}
+			sorted[j] = p;
+		}
+	}
+}
+
 void hook_notify(enum hook_type type)
 {
-	const struct hook_data *start, *end, *p;
-	int count, called = 0;
-	int last_prio = HOOK_PRIO_FIRST - 1, prio;
+	const struct hook_data **sorted;
+	int count, i;
 #ifdef CONFIG_HOOK_DEBUG
 	uint64_t start_time = get_time().val;
 	uint64_t run_time;
@@ -114,27 +275,12 @@ void hook_notify(enum hook_type type)
 
 	CPRINTS("hook notify %d", type);
 
-	start = hook_list[type].start;
-	end = hook_list[type].end;
-	count = end - start;
+	sorted = hook_sorted_list(type);
+	count = hook_list[type].end - hook_list[type].start;
 
 	/* Call all the hooks in priority order */
-	while (called < count) {
-		/* Find the lowest remaining priority */
-		for (p = start, prio = HOOK_PRIO_LAST + 1; p < end; p++) {
-			if (p->priority < prio && p->priority > last_prio)
-				prio = p->priority;
-		}
-		last_prio = prio;
-
-		/* Call all the hooks with that priority */
-		for (p = start; p < end; p++) {
-			if (p->priority == prio) {
-				called++;
-				p->routine();
-			}
-		}
-	}
+	for (i = 0; i < count; i++)
+		sorted[i]->routine();
 
 #ifdef CONFIG_HOOK_DEBUG
 	run_time = get_time().val - start_time;
@@ -154,9 +300,11 @@ int hook_call_deferred(const struct deferred_data *data, int us)
 	if (us == -1) {
 		/* Cancel */
 		__deferred_until[i] = 0;
+		atomic_or(&__deferred_changed[i / 32], BIT(i % 32));
 	} else {
 		/* Set alarm */
 		__deferred_until[i] = get_time().val + us;
+		atomic_or(&__deferred_changed[i / 32], BIT(i % 32));
 		/*
 		 * Flag that hook_call_deferred() has been called.  If the hook
 		 * task is already active, this will allow it to go through the
@@ -188,21 +336,33 @@ void hook_task(void *u)
 
 	while (1) {
 		uint64_t t = get_time().val;
+		uint64_t until;
 		int next = 0;
 		int i;
 
-		/* Handle deferred routines */
-		for (i = 0; i < DEFERRED_FUNCS_COUNT; i++) {
-			if (__deferred_until[i] && __deferred_until[i] < t) {
-				CPRINTS("hook call deferred 0x%pP",
-					__deferred_funcs[i].routine);
-				/*
-				 * Call deferred function.  Clear timer first,
-				 * so it can request itself be called later.
-				 */
-				__deferred_until[i] = 0;
-				__deferred_funcs[i].routine();
-			}
+		/* Handle deferred routines, which are due first in the list */
+		deferred_list_sync();
+		while (deferred_head != DEFERRED_LIST_END) {
+			i = deferred_head - 1;
+			until = __deferred_until[i];
+			if (!until || until >= t)
+				break;
+
+			CPRINTS("hook call deferred 0x%pP",
+				__deferred_funcs[i].routine);
+#ifdef CONFIG_HOOK_DEBUG
+			record_deferred_latency(get_time().val - until);
+#endif
+			/*
+			 * Call deferred function.  Clear timer first,
+			 * so it can request itself be called later.
+			 */
+			deferred_head = __deferred_next[i];
+			__deferred_next[i] = 0;
+			__deferred_until[i] = 0;
+			__deferred_funcs[i].routine();
+
+			deferred_list_sync();
 		}
 
 		if (t - last_tick >= HOOK_TICK_INTERVAL) {
@@ -233,14 +393,14 @@ void hook_task(void *u)
 		/* Wake earlier if needed by a deferred routine */
 		defer_new_call = 0;
 
-		for (i = 0; i < DEFERRED_FUNCS_COUNT && next > 0; i++) {
-			if (!__deferred_until[i])
-				continue;
+		deferred_list_sync();
+		if (deferred_head != DEFERRED_LIST_END && next > 0) {
+			until = __deferred_until[deferred_head - 1];
 
-			if (__deferred_until[i] < t)
+			if (!until || until < t)
 				next = 0;
-			else if (__deferred_until[i] - t < next)
-				next = __deferred_until[i] - t;
+			else if (until - t < next)
+				next = until - t;
 		}
 
 		/*
@@ -284,6 +444,14 @@ static int command_stats(int argc, char **argv)
 			 (uint32_t)max_hook_run_time[i],
 			 (uint32_t)avg_hook_run_time[i]);
 
+	ccprintf("\nDeferred call latency:\n");
+	for (i = 0; i < ARRAY_SIZE(deferred_latency_limit); ++i)
+		ccprintf("  < %6d us: %d\n", deferred_latency_limit[i],
+			 deferred_latency_count[i]);
+	ccprintf("  >=%6d us: %d\n", deferred_latency_limit[i - 1],
+		 deferred_latency_count[i]);
+	ccprintf("  Max:      %7d us\n", (uint32_t)max_deferred_latency);
+
 	return EC_SUCCESS;
 }
 DECLARE_CONSOLE_COMMAND(hookstats, command_stats,
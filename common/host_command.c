@@ -95,8 +95,47 @@ uint8_t *host_get_memmap(int offset)
 #endif
 }
 
+void host_response_add_iov(struct host_cmd_handler_args *args,
+			   const void *data, int size)
+{
+	ASSERT(args->response_iov_count < HOST_RESPONSE_IOV_MAX);
+
+	args->response_iov[args->response_iov_count].data = data;
+	args->response_iov[args->response_iov_count].size = size;
+	args->response_iov_count++;
+	args->response_size += size;
+}
+
+void host_response_gather_iov(struct host_cmd_handler_args *args)
+{
+	uint8_t *out = args->response;
+	int i;
+
+	for (i = 0; i < args->response_iov_count; i++) {
+		memcpy(out, args->response_iov[i].data,
+		       args->response_iov[i].size);
+		out += args->response_iov[i].size;
+	}
+	args->response_iov_count = 0;
+}
+
+void host_packet_respond(struct host_cmd_handler_args *args);
+#ifdef CONFIG_HOSTCMD_BATCH
+static void host_batch_send_response(struct host_cmd_handler_args *args);
+#endif
+
 test_mockable void host_send_response(struct host_cmd_handler_args *args)
 {
+#ifdef CONFIG_HOSTCMD_BATCH
+	/*
+	 * A batch sub-command responding by itself must not mark the batch
+	 * as pending; the batch reports it as failed instead.
+	 */
+	if (args->send_response == host_batch_send_response) {
+		args->send_response(args);
+		return;
+	}
+#endif
 #ifdef CONFIG_HOST_COMMAND_STATUS
 	/*
 	 *
@@ -196,8 +235,9 @@ void host_packet_respond(struct host_cmd_handler_args *args)
 {
 	struct ec_host_response *r = (struct ec_host_response *)pkt0->response;
 	uint8_t *out = (uint8_t *)pkt0->response;
+	const uint8_t *d;
 	int csum = 0;
-	int i;
+	int i, j;
 
 	/* Clip result size to what we can accept */
 	if (args->result) {
@@ -208,6 +248,9 @@ void host_packet_respond(struct host_cmd_handler_args *args)
 		args->result = EC_RES_RESPONSE_TOO_BIG;
 		args->response_size = 0;
 	}
+	if (!args->response_size)
+		args->response_iov_count = 0;
+	pkt0->response_iov_count = 0;
 
 	/* Fill in response struct */
 	r->struct_version = EC_HOST_RESPONSE_VERSION;
@@ -221,8 +264,28 @@ void host_packet_respond(struct host_cmd_handler_args *args)
 		csum += *out++;
 
 	/* Checksum response data, if any */
-	for (i = args->response_size; i > 0; i--)
-		csum += *out++;
+	if (!args->response_iov_count) {
+		for (i = args->response_size; i > 0; i--)
+			csum += *out++;
+	} else if (pkt0->response_iov_ok) {
+		/* Driver sends the segments from where they are */
+		for (j = 0; j < args->response_iov_count; j++) {
+			d = args->response_iov[j].data;
+			for (i = args->response_iov[j].size; i > 0; i--)
+				csum += *d++;
+		}
+		pkt0->response_iov = args->response_iov;
+		pkt0->response_iov_count = args->response_iov_count;
+	} else {
+		/* Copy segments in behind the header */
+		for (j = 0; j < args->response_iov_count; j++) {
+			d = args->response_iov[j].data;
+			for (i = args->response_iov[j].size; i > 0; i--) {
+				csum += *d;
+				*out++ = *d++;
+			}
+		}
+	}
 
 	/* Write checksum field so the entire packet sums to 0 */
 	r->checksum = (uint8_t)(-csum);
@@ -346,6 +409,7 @@ void host_packet_receive(struct host_packet *pkt)
 	args0.response_max = pkt->response_max -
 		sizeof(struct ec_host_response);
 	args0.response_size = 0;
+	args0.response_iov_count = 0;
 	args0.result = EC_RES_SUCCESS;
 
 	/* Chain to host command received */
@@ -362,38 +426,116 @@ host_packet_bad:
 	host_packet_respond(&args0);
 }
 
+/*
+ * Host commands are looked up through an open-addressed hash table in
+ * __hcmds_index, which the linker scripts size to two slots per command.
+ * Each slot holds an index into __hcmds plus one, or 0 if the slot is empty.
+ */
+#define HCMD_INDEX_SIZE (__hcmds_index_end - __hcmds_index)
+
+/*
+ * The linker scripts size the table, and the stats table, from the size of
+ * __hcmds with the struct size written out: 16 bytes on the 64-bit host
+ * (host_exe.lds), 12 bytes on the 32-bit cores (ec.lds.S).
+ */
+#ifdef CHIP_HOST
+BUILD_ASSERT(sizeof(struct host_command) == 16);
+#else
+BUILD_ASSERT(sizeof(struct host_command) == 12);
+#endif
+
+/* Set once the hash table has been built */
+static int hcmd_index_valid;
+
 /**
- * Find a command by command number.
+ * Hash a command number to a slot in the lookup table.
  *
- * @param command	Command number to find
- * @return The command structure, or NULL if no match found.
+ * Multiplicative hashing, scaled to the table size without a divide.
  */
-static const struct host_command *find_host_command(int command)
+static int hcmd_hash(int command)
 {
-#ifdef CONFIG_HOSTCMD_SECTION_SORTED
-	const struct host_command *l, *r, *m;
-	uint32_t num;
+	uint32_t h = (uint32_t)command * 2654435761u;
 
-/* Use binary search to locate host command handler */
-	l = __hcmds;
-	r = __hcmds_end - 1;
+	return ((h >> 16) * HCMD_INDEX_SIZE) >> 16;
+}
 
-	while (1) {
-		if (l > r)
-			return NULL;
+/**
+ * Build the host command lookup table.
+ */
+static void host_command_index_init(void)
+{
+	const struct host_command *cmd;
+	int i;
 
-		num = r - l;
-		m = l + (num / 2);
+	/* Slots hold 8-bit indices; larger tables fall back to a scan */
+	if (__hcmds_end - __hcmds >= 0xff)
+		return;
 
-		if (m->command < command)
-			l = m + 1;
-		else if (m->command > command)
-			r = m - 1;
-		else
-			return m;
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		/*
+		 * Linear probing.  If a command is declared twice, the first
+		 * one keeps the earlier slot and is found first, as with a
+		 * scan.
+		 */
+		i = hcmd_hash(cmd->command);
+		while (__hcmds_index[i]) {
+			if (++i == HCMD_INDEX_SIZE)
+				i = 0;
+		}
+		__hcmds_index[i] = cmd - __hcmds + 1;
 	}
-#else
+
+	hcmd_index_valid = 1;
+}
+
+#ifdef CONFIG_HOSTCMD_STATS
+/* The linker scripts reserve 44 bytes per command for the stats table */
+BUILD_ASSERT(sizeof(struct host_command_stats) == 44);
+
+/*
+ * Time spent in host commands run by the current handler, such as batch
+ * sub-commands.  Each command is recorded once, under its own entry, so the
+ * outer handler is only charged for the rest.
+ */
+static uint32_t hcmd_nested_us;
+
+static void host_command_record(const struct host_command *cmd, uint32_t us)
+{
+	struct host_command_stats *s = __hcmds_stats + (cmd - __hcmds);
+	int bucket = us ? MIN(__fls(us), EC_HOSTCMD_STATS_BUCKETS - 1) : 0;
+
+	s->count++;
+	s->total_us += us;
+	if (us > s->max_us)
+		s->max_us = us;
+	if (s->histogram[bucket] < UINT16_MAX)
+		s->histogram[bucket]++;
+}
+#endif
+
+/**
+ * Find a command by command number.
+ *
+ * @param command	Command number to find
+ * @return The command structure, or NULL if no match found.
+ */
+static const struct host_command *find_host_command(int command)
+{
 	const struct host_command *cmd;
+	int i;
+
+	if (hcmd_index_valid) {
+		/* The table is at most half full, so this terminates */
+		i = hcmd_hash(command);
+		while (__hcmds_index[i]) {
+			cmd = __hcmds + __hcmds_index[i] - 1;
+			if (cmd->command == command)
+				return cmd;
+			if (++i == HCMD_INDEX_SIZE)
+				i = 0;
+		}
+		return NULL;
+	}
 
 	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
 		if (command == cmd->command)
@@ -401,11 +543,12 @@ static const struct host_command *find_host_command(int command)
 	}
 
 	return NULL;
-#endif
 }
 
 static void host_command_init(void)
 {
+	host_command_index_init();
+
 	/* Initialize memory map ID area */
 	host_get_memmap(EC_MEMMAP_ID)[0] = 'E';
 	host_get_memmap(EC_MEMMAP_ID)[1] = 'C';
@@ -686,6 +829,7 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 	 * by this point (see host_packet_receive function).
 	 */
 	memset(args->response, 0, args->response_max);
+	args->response_iov_count = 0;
 
 #ifdef CONFIG_HOSTCMD_PD
 	if (args->command >= EC_CMD_PASSTHRU_OFFSET(1) &&
@@ -710,20 +854,239 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 			rv = EC_RES_INVALID_COMMAND;
 		else if (!(EC_VER_MASK(args->version) & cmd->version_mask))
 			rv = EC_RES_INVALID_VERSION;
-		else
+		else {
+#ifdef CONFIG_HOSTCMD_STATS
+			uint32_t outer_nested_us = hcmd_nested_us;
+			uint32_t start = get_time().le.lo;
+			uint32_t us;
+
+			hcmd_nested_us = 0;
+			rv = cmd->handler(args);
+			us = get_time().le.lo - start;
+			host_command_record(cmd, us - hcmd_nested_us);
+			hcmd_nested_us = outer_nested_us + us;
+#else
 			rv = cmd->handler(args);
+#endif
+		}
 	}
 
+	/*
+	 * Only the packet path knows how to hand data segments to the driver;
+	 * everyone else expects the whole response in the buffer.
+	 */
+	if (args->response_iov_count &&
+	    args->send_response != host_packet_respond)
+		host_response_gather_iov(args);
+
 	if (rv != EC_RES_SUCCESS)
 		CPRINTS("HC 0x%02x err %d", args->command, rv);
 
-	if (hcdebug >= HCDEBUG_PARAMS && args->response_size)
+	if (hcdebug >= HCDEBUG_PARAMS && args->response_size &&
+	    !args->response_iov_count)
 		CPRINTS("HC resp:%ph",
 			HEX_BUF(args->response, args->response_size));
 
 	return rv;
 }
 
+#ifdef CONFIG_HOSTCMD_BATCH
+/* Set when a batch sub-command sends its response before returning */
+static int batch_sub_responded;
+
+/* Sub-commands in a batch respond as part of the batch */
+static void host_batch_send_response(struct host_cmd_handler_args *args)
+{
+	batch_sub_responded = 1;
+}
+
+static enum ec_status host_command_batch(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_batch *p = args->params;
+	struct ec_response_batch *r = args->response;
+	const uint8_t *in = (const uint8_t *)(p + 1);
+	const uint8_t *in_end = (const uint8_t *)args->params +
+		args->params_size;
+	uint8_t *out = (uint8_t *)(r + 1);
+	uint8_t *out_end = (uint8_t *)args->response + args->response_max;
+	const struct ec_batch_request *req;
+	struct ec_batch_response *resp;
+	struct host_cmd_handler_args sub;
+	int i;
+
+	if (args->params_size < sizeof(*p) ||
+	    args->response_max < sizeof(*r))
+		return EC_RES_INVALID_PARAM;
+
+	for (i = 0; i < p->count; i++) {
+		req = (const struct ec_batch_request *)in;
+		if (in_end - in < (int)sizeof(*req) ||
+		    in_end - in - (int)sizeof(*req) < req->data_len)
+			return EC_RES_INVALID_PARAM;
+
+		/* Stop once there is no room left to report a result */
+		if (out_end - out < (int)sizeof(*resp))
+			break;
+		resp = (struct ec_batch_response *)out;
+
+		sub.send_response = host_batch_send_response;
+		sub.command = req->command;
+		sub.version = req->command_version;
+		sub.params = req + 1;
+		sub.params_size = req->data_len;
+		sub.response = resp + 1;
+		sub.response_max = out_end - out - sizeof(*resp);
+		sub.response_size = 0;
+
+		/*
+		 * Commands known to respond early are refused up front. Any
+		 * other which responds early or is still in progress needs a
+		 * follow-up from the host that a batch can't give, so it
+		 * fails too.
+		 */
+		batch_sub_responded = 0;
+		if (sub.command == EC_CMD_BATCH ||
+		    sub.command == EC_CMD_REBOOT_EC ||
+		    sub.command == EC_CMD_FLASH_ERASE)
+			sub.result = EC_RES_INVALID_COMMAND;
+		else
+			sub.result = host_command_process(&sub);
+		if (batch_sub_responded || sub.result == EC_RES_IN_PROGRESS)
+			sub.result = EC_RES_INVALID_COMMAND;
+
+		if (sub.result != EC_RES_SUCCESS) {
+			sub.response_size = 0;
+		} else if (sub.response_size > sub.response_max) {
+			sub.result = EC_RES_RESPONSE_TOO_BIG;
+			sub.response_size = 0;
+		}
+
+		resp->result = sub.result;
+		resp->data_len = sub.response_size;
+
+		/*
+		 * host_command_process() zeroed the rest of the buffer, so
+		 * the padding is already clear.
+		 */
+		in += sizeof(*req) + ((req->data_len + 3) & ~3);
+		out += sizeof(*resp) + ((sub.response_size + 3) & ~3);
+		if (out > out_end)
+			out = out_end;
+
+		if (sub.result != EC_RES_SUCCESS &&
+		    (p->flags & EC_BATCH_FLAG_STOP_ON_ERROR)) {
+			i++;
+			break;
+		}
+	}
+
+	r->count = i;
+	args->response_size = out - (uint8_t *)args->response;
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_BATCH,
+		     host_command_batch,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_HOSTCMD_BATCH */
+
+#ifdef CONFIG_HOSTCMD_STATS
+static void host_command_stats_reset(void)
+{
+	memset(__hcmds_stats, 0,
+	       (__hcmds_stats_end - __hcmds_stats) * sizeof(*__hcmds_stats));
+}
+
+static enum ec_status
+host_command_get_stats(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_hostcmd_stats *p = args->params;
+	struct ec_response_hostcmd_stats *r = args->response;
+	struct ec_hostcmd_stats_entry *e;
+	const struct host_command_stats *s;
+	int max, i;
+
+	if (args->response_max < sizeof(*r) + sizeof(*e))
+		return EC_RES_RESPONSE_TOO_BIG;
+	max = MIN((int)((args->response_max - sizeof(*r)) / sizeof(*e)),
+		  UINT8_MAX);
+
+	if (p->flags & EC_HOSTCMD_STATS_FLAG_RESET)
+		host_command_stats_reset();
+
+	for (i = p->index; i < __hcmds_end - __hcmds; i++) {
+		s = __hcmds_stats + i;
+		if (!s->count)
+			continue;
+		if (r->count == max) {
+			r->next_index = i;
+			break;
+		}
+		e = r->entries + r->count++;
+		e->command = __hcmds[i].command;
+		e->count = s->count;
+		e->total_us = s->total_us;
+		e->max_us = s->max_us;
+		memcpy(e->histogram, s->histogram, sizeof(e->histogram));
+	}
+
+	args->response_size = sizeof(*r) + r->count * sizeof(*e);
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_HOSTCMD_STATS,
+		     host_command_get_stats,
+		     EC_VER_MASK(0));
+
+static void print_host_command_histogram(const struct host_command_stats *s)
+{
+	int i;
+
+	for (i = 0; i < EC_HOSTCMD_STATS_BUCKETS; i++) {
+		if (!s->histogram[i])
+			continue;
+		if (i == EC_HOSTCMD_STATS_BUCKETS - 1)
+			ccprintf("  >= %6d us: %d\n", 1 << i, s->histogram[i]);
+		else
+			ccprintf("  < %7d us: %d\n", 2 << i, s->histogram[i]);
+	}
+}
+
+static int command_hcstats(int argc, char **argv)
+{
+	const struct host_command_stats *s;
+	int cmd = -1;
+	int i;
+	char *e;
+
+	if (argc > 1) {
+		if (!strcasecmp(argv[1], "reset")) {
+			host_command_stats_reset();
+			return EC_SUCCESS;
+		}
+		cmd = strtoi(argv[1], &e, 0);
+		if (*e)
+			return EC_ERROR_PARAM1;
+	}
+
+	ccprintf("Cmd       Count   Avg us   Max us\n");
+	for (i = 0; i < __hcmds_end - __hcmds; i++) {
+		s = __hcmds_stats + i;
+		if (!s->count || (cmd >= 0 && __hcmds[i].command != cmd))
+			continue;
+		ccprintf("0x%04x %8d %8d %8d\n", __hcmds[i].command, s->count,
+			 s->total_us / s->count, s->max_us);
+		if (cmd >= 0)
+			print_host_command_histogram(s);
+		cflush();
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(hcstats, command_hcstats,
+			"[reset | cmd]",
+			"Print host command handler statistics");
+#endif /* CONFIG_HOSTCMD_STATS */
+
 #ifdef CONFIG_HOST_COMMAND_STATUS
 /* Returns current command status (busy or not) */
 static enum ec_status
@@ -15,23 +15,27 @@ void kasa_reset(struct kasa_fit *kasa)
 
 void kasa_accumulate(struct kasa_fit *kasa, fp_t x, fp_t y, fp_t z)
 {
-	fp_t w = fp_sq(x) + fp_sq(y) + fp_sq(z);
+	/* Each square is used twice, so only compute it once */
+	fp_t xx = fp_sq(x);
+	fp_t yy = fp_sq(y);
+	fp_t zz = fp_sq(z);
+	fp_t w = xx + yy + zz;
 
 	kasa->acc_x += x;
 	kasa->acc_y += y;
 	kasa->acc_z += z;
 	kasa->acc_w += w;
 
-	kasa->acc_xx += fp_sq(x);
+	kasa->acc_xx += xx;
 	kasa->acc_xy += fp_mul(x, y);
 	kasa->acc_xz += fp_mul(x, z);
 	kasa->acc_xw += fp_mul(x, w);
 
-	kasa->acc_yy += fp_sq(y);
+	kasa->acc_yy += yy;
 	kasa->acc_yz += fp_mul(y, z);
 	kasa->acc_yw += fp_mul(y, w);
 
-	kasa->acc_zz += fp_sq(z);
+	kasa->acc_zz += zz;
 	kasa->acc_zw += fp_mul(z, w);
 
 	kasa->nsamples += 1;
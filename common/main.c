@@ -80,6 +80,9 @@ test_mockable __keep int main(void)
 
 	gpio_pre_init();
 
+	/* Sort the hooks before anything can notify them. */
+	hook_init();
+
 #ifdef CONFIG_BOARD_POST_GPIO_INIT
 	board_config_post_gpio_init();
 #endif
@@ -322,16 +322,26 @@ int tcpci_i2c_xfer(int port, uint16_t slave_addr_flags,
 		memcpy(in, rx_buffer, in_size);
 		rx_pos += in_size;
 	} else if (out_size == 1) {
-		if (in_size != reg->size) {
+		if (in_size < reg->size) {
 			ccprints("ERROR: %s in_size %d != %d", reg->name,
 				 in_size, reg->size);
 			return EC_ERROR_UNKNOWN;
 		}
-		if (reg->size == 1)
-			in[0] = reg->value;
-		else if (reg->size == 2) {
+		/* Block reads continue with the following registers */
+		while (in_size > 0) {
+			if (reg >= tcpci_regs + ARRAY_SIZE(tcpci_regs) ||
+			    reg->size == 0 || reg->size > 2 ||
+			    in_size < reg->size) {
+				ccprints("ERROR: block read past %s",
+					 (reg - 1)->name);
+				return EC_ERROR_UNKNOWN;
+			}
 			in[0] = reg->value;
-			in[1] = reg->value >> 8;
+			if (reg->size == 2)
+				in[1] = reg->value >> 8;
+			in += reg->size;
+			in_size -= reg->size;
+			reg += reg->size;
 		}
 	} else {
 		uint16_t value = 0;
@@ -39,3 +39,8 @@ void dpm_vdm_naked(int port, enum tcpm_transmit_type type, uint16_t svid,
 void dpm_run(int port)
 {
 }
+
+bool dpm_has_work(int port)
+{
+	return false;
+}
@@ -587,8 +587,64 @@ static inline void update_sense_data(uint8_t *lpc_status, int *psample_id)
 }
 #endif
 
-static int motion_sense_read(struct motion_sensor_t *sensor)
+/*
+ * Sensors already read by a group read earlier in this pass of the motion
+ * sense task, and the time of that read.
+ */
+static uint32_t group_read_pending;
+static uint32_t group_read_time;
+
+/**
+ * Find the other sensors on the same chip as <sensor> that are due to be read
+ * in this pass of the motion sense task, so they can be read together.
+ * Sensors before <sensor> have already had their turn in this pass.
+ */
+static uint32_t motion_sense_read_group(const struct motion_sensor_t *sensor,
+					const timestamp_t *ts)
+{
+	uint32_t group = 0;
+	int i;
+
+	for (i = sensor - motion_sensors + 1; i < motion_sensor_count; i++) {
+		struct motion_sensor_t *s = &motion_sensors[i];
+
+		if (s->drv != sensor->drv || s->port != sensor->port ||
+		    s->i2c_spi_addr_flags != sensor->i2c_spi_addr_flags)
+			continue;
+
+		if (!SENSOR_ACTIVE(s) || s->state != SENSOR_INITIALIZED ||
+		    !motion_sensor_in_forced_mode(s) ||
+		    !motion_sensor_time_to_read(ts, s) ||
+		    s->drv->get_data_rate(s) == 0)
+			continue;
+
+#ifdef CONFIG_ACCEL_SPOOF_MODE
+		if (s->flags & MOTIONSENSE_FLAG_IN_SPOOF_MODE)
+			continue;
+#endif
+		group |= BIT(i);
+	}
+
+	return group;
+}
+
+/**
+ * Read the raw X,Y,Z data of a sensor in forced mode.
+ *
+ * @param sensor	Sensor to read.
+ * @param ts		Start time of this pass of the motion sense task.
+ * @param read_time	Set to the hardware clock time of the read.
+ * @return EC_SUCCESS, or non-zero if error.
+ */
+static int motion_sense_read(struct motion_sensor_t *sensor,
+			     const timestamp_t *ts, uint32_t *read_time)
 {
+	uint32_t sensor_bit = BIT(sensor - motion_sensors);
+	uint32_t group;
+	int ret;
+
+	*read_time = __hw_clock_source_read();
+
 	if (sensor->state != SENSOR_INITIALIZED)
 		return EC_ERROR_UNKNOWN;
 
@@ -604,8 +660,30 @@ static int motion_sense_read(struct motion_sensor_t *sensor)
 		return EC_SUCCESS;
 #endif /* defined(CONFIG_ACCEL_SPOOF_MODE) */
 
+	/* Already read along with another sensor of the same chip. */
+	if (group_read_pending & sensor_bit) {
+		group_read_pending &= ~sensor_bit;
+		*read_time = group_read_time;
+		return EC_SUCCESS;
+	}
+
+	/* Read the other sensors of the chip now if they are due too. */
+	group = sensor->drv->read_group ?
+		motion_sense_read_group(sensor, ts) : 0;
+	if (group) {
+		ret = sensor->drv->read_group(sensor, group | sensor_bit);
+		*read_time = __hw_clock_source_read();
+		if (ret == EC_SUCCESS) {
+			group_read_pending |= group;
+			group_read_time = *read_time;
+		}
+		return ret;
+	}
+
 	/* Otherwise, read all raw X,Y,Z accelerations. */
-	return sensor->drv->read(sensor, sensor->raw_xyz);
+	ret = sensor->drv->read(sensor, sensor->raw_xyz);
+	*read_time = __hw_clock_source_read();
+	return ret;
 }
 
 
@@ -638,7 +716,8 @@ static inline void increment_sensor_collection(struct motion_sensor_t *sensor,
  *
  * @param s Pointer to the sensor.
  */
-static void motion_sense_push_raw_xyz(struct motion_sensor_t *s)
+static void motion_sense_push_raw_xyz(struct motion_sensor_t *s,
+				      uint32_t read_time)
 {
 	if (IS_ENABLED(CONFIG_ACCEL_FIFO)) {
 		struct ec_response_motion_sensor_data vector;
@@ -656,8 +735,7 @@ static void motion_sense_push_raw_xyz(struct motion_sensor_t *s)
 
 		mutex_unlock(&g_sensor_mutex);
 
-		motion_sense_fifo_stage_data(&vector, s, 3,
-					     __hw_clock_source_read());
+		motion_sense_fifo_stage_data(&vector, s, 3, read_time);
 		motion_sense_fifo_commit_data();
 	} else {
 		mutex_lock(&g_sensor_mutex);
@@ -674,6 +752,7 @@ static int motion_sense_process(struct motion_sensor_t *sensor,
 	int is_odr_pending = 0;
 	int has_data_read = 0;
 	int sensor_num = sensor - motion_sensors;
+	uint32_t read_time;
 
 	if (*event & TASK_EVENT_MOTION_ODR_CHANGE) {
 		const int sensor_bit = 1 << sensor_num;
@@ -694,14 +773,14 @@ static int motion_sense_process(struct motion_sensor_t *sensor,
 #endif /* CONFIG_ACCEL_INTERRUPTS */
 	if (motion_sensor_in_forced_mode(sensor)) {
 		if (motion_sensor_time_to_read(ts, sensor)) {
-			ret = motion_sense_read(sensor);
+			ret = motion_sense_read(sensor, ts, &read_time);
 			increment_sensor_collection(sensor, ts);
 		} else {
 			ret = EC_ERROR_BUSY;
 		}
 
 		if (ret == EC_SUCCESS) {
-			motion_sense_push_raw_xyz(sensor);
+			motion_sense_push_raw_xyz(sensor, read_time);
 			has_data_read = 1;
 		}
 	}
@@ -886,6 +965,7 @@ void motion_sense_task(void *u)
 
 	while (1) {
 		ts_begin_task = get_time();
+		group_read_pending = 0;
 		for (i = 0; i < motion_sensor_count; ++i) {
 
 			sensor = &motion_sensors[i];
@@ -1319,6 +1399,17 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 	case MOTIONSENSE_CMD_FIFO_READ:
 		if (!IS_ENABLED(CONFIG_ACCEL_FIFO))
 			return EC_RES_INVALID_PARAM;
+		if (args->version >= 5) {
+			out->fifo_read_packed.number_data =
+				motion_sense_fifo_read_packed(
+					args->response_max -
+					sizeof(out->fifo_read_packed),
+					in->fifo_read.max_data_vector,
+					out->fifo_read_packed.data,
+					&(args->response_size));
+			args->response_size += sizeof(out->fifo_read_packed);
+			break;
+		}
 		out->fifo_read.number_data = motion_sense_fifo_read(
 			args->response_max - sizeof(out->fifo_read),
 			in->fifo_read.max_data_vector,
@@ -1504,7 +1595,7 @@ static enum ec_status host_cmd_motion_sense(struct host_cmd_handler_args *args)
 
 DECLARE_HOST_COMMAND(EC_CMD_MOTION_SENSE_CMD, host_cmd_motion_sense,
 		     EC_VER_MASK(1) | EC_VER_MASK(2) | EC_VER_MASK(3) |
-		     EC_VER_MASK(4));
+		     EC_VER_MASK(4) | EC_VER_MASK(5));
 
 /*****************************************************************************/
 /* Console commands */
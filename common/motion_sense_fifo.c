@@ -590,6 +590,194 @@ int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 	return count;
 }
 
+/**
+ * Write a varint.
+ *
+ * @param out Where to write the varint, up to 5 bytes.
+ * @param v The value to write.
+ * @return The number of bytes written.
+ */
+static int put_varint(uint8_t *out, uint32_t v)
+{
+	int len = 0;
+
+	while (v >= 0x80) {
+		out[len++] = v | 0x80;
+		v >>= 7;
+	}
+	out[len++] = v;
+	return len;
+}
+
+static inline uint32_t zigzag(int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/**
+ * Earlier values in a packed response, the base of the differences.
+ * @timestamp: The previous timestamp.
+ * @sampled: Bitmap of the sensors with a sample entry.
+ * @sample_ts: Timestamp of the previous sample entry of each sensor.
+ * @interval: Interval between the two previous sample entries of each sensor.
+ * @data: Previous data of each sensor.
+ */
+struct fifo_pack_state {
+	uint32_t timestamp;
+	uint32_t sampled;
+	uint32_t sample_ts[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE];
+	uint32_t interval[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE];
+	int16_t data[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE][3];
+};
+
+static inline const struct ec_response_motion_sensor_data *
+get_fifo_entry(size_t offset)
+{
+	return ((struct ec_response_motion_sensor_data *) fifo.buffer) +
+		((fifo.state->head + offset) & fifo.buffer_units_mask);
+}
+
+static uint8_t pack_header(const struct ec_response_motion_sensor_data *data,
+			   enum motionsense_fifo_packed_type type,
+			   uint8_t sensor)
+{
+	uint8_t header = sensor | (type << MOTIONSENSE_FIFO_PACKED_TYPE_SHIFT);
+
+	if (data->flags & MOTIONSENSE_SENSOR_FLAG_TABLET_MODE)
+		header |= MOTIONSENSE_FIFO_PACKED_TABLET_MODE;
+	if (data->flags & MOTIONSENSE_SENSOR_FLAG_WAKEUP)
+		header |= MOTIONSENSE_FIFO_PACKED_WAKEUP;
+	return header;
+}
+
+static int pack_xyz(struct fifo_pack_state *state,
+		    const struct ec_response_motion_sensor_data *data,
+		    uint8_t *out)
+{
+	int16_t *prev = state->data[data->sensor_num];
+	int len = 0;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		len += put_varint(out + len, zigzag(data->data[i] - prev[i]));
+		prev[i] = data->data[i];
+	}
+	return len;
+}
+
+/**
+ * Check if a timestamp and the entry after it can be packed as a sample.
+ */
+static bool is_packable_sample(const struct ec_response_motion_sensor_data *ts,
+			       const struct ec_response_motion_sensor_data *data)
+{
+	const uint8_t tablet = MOTIONSENSE_SENSOR_FLAG_TABLET_MODE;
+
+	return (ts->flags & ~tablet) == MOTIONSENSE_SENSOR_FLAG_TIMESTAMP &&
+	       ts->sensor_num < MOTIONSENSE_FIFO_PACKED_SENSOR_NONE &&
+	       data->sensor_num == ts->sensor_num &&
+	       (data->flags & ~(tablet | MOTIONSENSE_SENSOR_FLAG_WAKEUP)) == 0 &&
+	       (data->flags & tablet) == (ts->flags & tablet);
+}
+
+/**
+ * Pack one or two fifo entries.
+ *
+ * @param state The earlier values in this response, updated.
+ * @param offset The offset of the first entry in the fifo.
+ * @param count The number of entries that can be packed from offset.
+ * @param out Where to write the packed entry, up to
+ *	  MOTIONSENSE_FIFO_PACKED_MAX_ENTRY bytes.
+ * @param units Set to the number of fifo entries packed.
+ * @return The number of bytes written.
+ */
+static int fifo_pack_unit(struct fifo_pack_state *state, size_t offset,
+			  int count, uint8_t *out, int *units)
+{
+	const struct ec_response_motion_sensor_data *data =
+		get_fifo_entry(offset);
+	const struct ec_response_motion_sensor_data *next;
+	uint8_t flags = data->flags & ~(MOTIONSENSE_SENSOR_FLAG_TABLET_MODE |
+					MOTIONSENSE_SENSOR_FLAG_WAKEUP);
+	uint8_t sensor = data->sensor_num;
+	uint32_t predicted;
+	int len = 1;
+
+	*units = 1;
+	next = count > 1 ? get_fifo_entry(offset + 1) : NULL;
+	if (next && is_packable_sample(data, next)) {
+		*units = 2;
+		out[0] = pack_header(next, MOTIONSENSE_FIFO_PACKED_SAMPLE,
+				     sensor);
+		if (state->sampled & BIT(sensor)) {
+			predicted = state->sample_ts[sensor] +
+				state->interval[sensor];
+			state->interval[sensor] =
+				data->timestamp - state->sample_ts[sensor];
+		} else {
+			predicted = state->timestamp;
+			state->interval[sensor] = 0;
+		}
+		len += put_varint(out + len,
+				  zigzag(data->timestamp - predicted));
+		state->sampled |= BIT(sensor);
+		state->sample_ts[sensor] = data->timestamp;
+		state->timestamp = data->timestamp;
+		return len + pack_xyz(state, next, out + len);
+	}
+
+	if (flags == 0 && sensor < MOTIONSENSE_FIFO_PACKED_SENSOR_NONE) {
+		out[0] = pack_header(data, MOTIONSENSE_FIFO_PACKED_DATA,
+				     sensor);
+		return len + pack_xyz(state, data, out + len);
+	}
+
+	if (flags == MOTIONSENSE_SENSOR_FLAG_TIMESTAMP &&
+	    (sensor < MOTIONSENSE_FIFO_PACKED_SENSOR_NONE || sensor == 0xff)) {
+		out[0] = pack_header(data, MOTIONSENSE_FIFO_PACKED_TIMESTAMP,
+				     MIN(sensor,
+					 MOTIONSENSE_FIFO_PACKED_SENSOR_NONE));
+		len += put_varint(out + len,
+				  zigzag(data->timestamp - state->timestamp));
+		state->timestamp = data->timestamp;
+		return len;
+	}
+
+	out[0] = MOTIONSENSE_FIFO_PACKED_RAW <<
+		MOTIONSENSE_FIFO_PACKED_TYPE_SHIFT;
+	memcpy(out + len, data, sizeof(*data));
+	return len + sizeof(*data);
+}
+
+int motion_sense_fifo_read_packed(int capacity_bytes, int max_count,
+				  void *out, uint16_t *out_size)
+{
+	/* Static to keep it off the host command stack. */
+	static struct fifo_pack_state state;
+	uint8_t unit[MOTIONSENSE_FIFO_PACKED_MAX_ENTRY];
+	uint8_t *dest = out;
+	int count, len, units;
+	int size = 0;
+	int i = 0;
+
+	mutex_lock(&g_sensor_mutex);
+	memset(&state, 0, sizeof(state));
+	count = MIN(queue_count(&fifo), max_count);
+	while (i < count) {
+		len = fifo_pack_unit(&state, i, count - i, unit, &units);
+		if (size + len > capacity_bytes)
+			break;
+		memcpy(dest + size, unit, len);
+		size += len;
+		i += units;
+	}
+	queue_advance_head(&fifo, i);
+	mutex_unlock(&g_sensor_mutex);
+	*out_size = size;
+
+	return i;
+}
+
 void motion_sense_fifo_reset(void)
 {
 	next_timestamp_initialized = 0;
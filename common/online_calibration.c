@@ -61,15 +61,36 @@ static void data_int16_to_fp(const struct motion_sensor_t *s,
 			     const int16_t *data, fpv3_t out)
 {
 	int i;
-	fp_t range = INT_TO_FP(s->drv->get_range(s));
+	int range = s->drv->get_range(s);
+	fp_t fp_range = INT_TO_FP(range);
+#ifdef CONFIG_FPU
+	/*
+	 * Scale by multiplying instead of dividing every sample.  Dividing by
+	 * 0x8000 is exact, so only positive values may differ from
+	 * (v / 0x7fff) * range, by at most one ulp.
+	 */
+	fp_t scale_pos = fp_range / 0x7fff;
+	fp_t scale_neg = fp_range / 0x8000;
+#endif
 
 	for (i = 0; i < 3; ++i) {
-		fp_t v = INT_TO_FP((int32_t)data[i]);
+		int32_t v = data[i];
 
-		out[i] = fp_div(v, INT_TO_FP((data[i] >= 0) ? 0x7fff : 0x8000));
-		out[i] = fp_mul(out[i], range);
+#ifdef CONFIG_FPU
+		out[i] = v * (v >= 0 ? scale_pos : scale_neg);
+#else
+		/*
+		 * Same result as fp_mul(fp_div(v, 0x7fff), range) in fixed
+		 * point, but with a 32-bit division by a constant rather than
+		 * a 64-bit division.  v << FP_BITS fits in 32 bits for int16.
+		 */
+		if (v >= 0)
+			out[i] = (v * (1 << FP_BITS)) / 0x7fff * range;
+		else
+			out[i] = (v * (1 << FP_BITS)) / 0x8000 * range;
+#endif
 		/* Check for overflow */
-		out[i] = CLAMP(out[i], -range, range);
+		out[i] = CLAMP(out[i], -fp_range, fp_range);
 	}
 }
 
@@ -185,13 +206,10 @@ void online_calibration_init(void)
 
 	for (i = 0; i < SENSOR_COUNT; i++) {
 		struct motion_sensor_t *s = motion_sensors + i;
-		void *type_specific_data = NULL;
+		void *type_specific_data =
+			s->online_calib_data->type_specific_data;
 
-		if (s->online_calib_data) {
-			s->online_calib_data->last_temperature = -1;
-			type_specific_data =
-				s->online_calib_data->type_specific_data;
-		}
+		s->online_calib_data->last_temperature = -1;
 
 		if (!type_specific_data)
 			continue;
@@ -237,7 +255,7 @@ bool online_calibration_read(int sensor_num, int16_t out[3])
 	if (has_valid) {
 		/* Update data in out */
 		memcpy(out, motion_sensors[sensor_num].online_calib_data->cache,
-		       sizeof(out));
+		       3 * sizeof(out[0]));
 		/* Clear dirty bit */
 		sensor_calib_cache_dirty_map &= ~(1 << sensor_num);
 	}
@@ -15,36 +15,22 @@ static const char error_str[] = "ERROR";
 #define MAX_FORMAT 1024  /* Maximum chars in a single format field */
 
 #ifndef CONFIG_DEBUG_PRINTF
-static inline int divmod(uint64_t *n, int d)
-{
-	return uint64divmod(n, d);
-}
-
+/* Widest integer type which can be printed */
+typedef uint64_t printf_uint_t;
 #else /* CONFIG_DEBUG_PRINTF */
 /* if we are optimizing for size, remove the 64-bit support */
 #define NO_UINT64_SUPPORT
-static inline int divmod(uint32_t *n, int d)
-{
-	int r = *n % d;
-	*n /= d;
-	return r;
-}
+typedef uint32_t printf_uint_t;
 #endif
 
-/**
- * Convert the lowest nibble of a number to hex
- *
- * @param c	Number to extract lowest nibble from
- *
- * @return The corresponding ASCII character ('0' - 'f').
- */
-static int hexdigit(int c)
-{
-	/* Strip off just the last nibble */
-	c &= 0x0f;
+static const char hex_digits[] = "0123456789abcdef";
+static const char hex_digits_upper[] = "0123456789ABCDEF";
 
-	return c > 9 ? (c + 'a' - 10) : (c + '0');
-}
+/* Powers of 10 which fit in 32 bits, for fixed point precision */
+static const uint32_t pow10[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+	1000000000,
+};
 
 /* Flags for vfnprintf() flags */
 #define PF_LEFT		BIT(0)  /* Left-justify */
@@ -58,15 +44,63 @@ static int hexdigit(int c)
 #define PF_64BIT	BIT(3)  /* Number is 64-bit */
 #endif
 
+/* Where vfnprintf_str() sends its output */
+struct printf_output {
+	int (*addchar)(void *context, int c);
+	int (*addstr)(void *context, const char *str, int len);
+	void *context;
+};
+
+/**
+ * Send len characters of str to the output.
+ *
+ * @return 0 if all characters were added, non-zero on overflow.
+ */
+static int emit(const struct printf_output *out, const char *str, int len)
+{
+	if (len <= 0)
+		return 0;
+
+	if (out->addstr)
+		return out->addstr(out->context, str, len);
+
+	for (; len; len--)
+		if (out->addchar(out->context, *str++))
+			return 1;
+	return 0;
+}
+
+/**
+ * Send len padding characters, '0' or ' ', to the output.
+ *
+ * @return 0 if all characters were added, non-zero on overflow.
+ */
+static int emit_pad(const struct printf_output *out, int c, int len)
+{
+	static const char zeros[] = "0000000000000000";
+	static const char spaces[] = "                ";
+	const char *pad = c == '0' ? zeros : spaces;
+	int n;
+
+	for (; len > 0; len -= n) {
+		n = MIN(len, (int)sizeof(zeros) - 1);
+		if (emit(out, pad, n))
+			return 1;
+	}
+	return 0;
+}
+
 /*
  * Print the buffer as a string of bytes in hex.
  * Returns 0 on success or an error on failure.
  */
-static int print_hex_buffer(int (*addchar)(void *context, int c),
-			    void *context, const char *vstr, int precision,
+static int print_hex_buffer(const struct printf_output *out,
+			    const char *vstr, int precision,
 			    int pad_width, int flags)
 
 {
+	char hex[32];
+	int n, i;
 
 	/*
 	 * Divide pad_width instead of multiplying precision to avoid overflow
@@ -79,30 +113,141 @@ static int print_hex_buffer(int (*addchar)(void *context, int c),
 	else
 		pad_width = 0;
 
-	while (pad_width > 0 && !(flags & PF_LEFT)) {
-		if (addchar(context, flags & PF_PADZERO ? '0' : ' '))
+	if (!(flags & PF_LEFT) &&
+	    emit_pad(out, flags & PF_PADZERO ? '0' : ' ', pad_width))
+		return EC_ERROR_OVERFLOW;
+
+	/* Convert and send the bytes in chunks */
+	for (; precision; precision -= n, vstr += n) {
+		n = MIN(precision, (int)sizeof(hex) / 2);
+		for (i = 0; i < n; i++) {
+			hex[2 * i] = hex_digits[(uint8_t)vstr[i] >> 4];
+			hex[2 * i + 1] = hex_digits[vstr[i] & 0x0f];
+		}
+		if (emit(out, hex, 2 * n))
 			return EC_ERROR_OVERFLOW;
-		pad_width--;
 	}
 
-	for (; precision; precision--, vstr++) {
-		if (addchar(context, hexdigit(*vstr >> 4)) ||
-		    addchar(context, hexdigit(*vstr)))
-			return EC_ERROR_OVERFLOW;
+	if ((flags & PF_LEFT) && emit_pad(out, ' ', pad_width))
+		return EC_ERROR_OVERFLOW;
+
+	return EC_SUCCESS;
+}
+
+/**
+ * Divide by 10 with a multiplication by the reciprocal, exact for all
+ * 32-bit values.
+ */
+static inline uint32_t div10(uint32_t n)
+{
+	return ((uint64_t)n * 0xcccccccd) >> 35;
+}
+
+/**
+ * Convert a 32-bit integer to decimal, backwards from the end of a buffer.
+ *
+ * @param end		End of the digits
+ * @param n		Number to convert
+ * @param min_digits	Minimum number of digits, padded with 0's
+ * @return Pointer to the first digit.
+ */
+static char *format_dec32(char *end, uint32_t n, int min_digits)
+{
+	char *p = end;
+	uint32_t q;
+
+	do {
+		q = div10(n);
+		*(--p) = '0' + n - q * 10;
+		n = q;
+	} while (n || end - p < min_digits);
+
+	return p;
+}
+
+/**
+ * Convert an integer to a string, backwards from the end of a buffer.
+ *
+ * @param end		End of the digits
+ * @param v		Number to convert
+ * @param base		10, 16 or 2
+ * @param upper		Use upper case hex digits
+ * @return Pointer to the first digit.
+ */
+static char *format_uint(char *end, printf_uint_t v, int base, int upper)
+{
+	const char *digits = upper ? hex_digits_upper : hex_digits;
+	int shift = base == 16 ? 4 : 1;
+	char *p = end;
+
+	if (base == 10) {
+#ifndef NO_UINT64_SUPPORT
+		/* Do 9 digits per 64-bit division, then stay in 32 bits */
+		while (v > UINT32_MAX)
+			p = format_dec32(p, uint64divmod(&v, pow10[9]), 9);
+#endif
+		return format_dec32(p, v, 1);
 	}
 
-	while (pad_width > 0 && (flags & PF_LEFT)) {
-		if (addchar(context, ' '))
-			return EC_ERROR_OVERFLOW;
-		pad_width--;
+	do {
+		*(--p) = digits[v & (base - 1)];
+		v >>= shift;
+	} while (v);
+
+	return p;
+}
+
+/**
+ * Convert the digits right of the decimal point of a fixed point number.
+ *
+ * @param end		End of the digits
+ * @param v		Number to convert, divided by 10^precision on return
+ * @param precision	Number of digits right of the decimal point
+ * @return Pointer to the first digit.
+ */
+static char *format_fraction(char *end, printf_uint_t *v, int precision)
+{
+	uint32_t frac;
+
+	if (!precision)
+		return end;
+
+	if (precision < (int)ARRAY_SIZE(pow10)) {
+#ifndef NO_UINT64_SUPPORT
+		if (*v > UINT32_MAX) {
+			frac = uint64divmod(v, pow10[precision]);
+			return format_dec32(end, frac, precision);
+		}
+#endif
+		frac = (uint32_t)*v % pow10[precision];
+		*v = (uint32_t)*v / pow10[precision];
+		return format_dec32(end, frac, precision);
 	}
 
-	return EC_SUCCESS;
+	/* More digits than fit in 32 bits, do them one at a time */
+	for (; precision; precision--) {
+#ifndef NO_UINT64_SUPPORT
+		if (*v > UINT32_MAX) {
+			*(--end) = '0' + uint64divmod(v, 10);
+			continue;
+		}
+#endif
+		frac = div10(*v);
+		*(--end) = '0' + (uint32_t)*v - frac * 10;
+		*v = frac;
+	}
+	return end;
 }
 
-int vfnprintf(int (*addchar)(void *context, int c), void *context,
-	      const char *format, va_list args)
+int vfnprintf_str(int (*addchar)(void *context, int c),
+		  int (*addstr)(void *context, const char *str, int len),
+		  void *context, const char *format, va_list args)
 {
+	const struct printf_output out = {
+		.addchar = addchar,
+		.addstr = addstr,
+		.context = context,
+	};
 	/*
 	 * Longest uint64 in decimal = 20
 	 * Longest uint32 in binary  = 32
@@ -110,6 +255,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	 * + terminating null
 	 */
 	char intbuf[34];
+	const char *run;
 	int flags;
 	int pad_width;
 	int precision;
@@ -117,15 +263,18 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	int vlen;
 
 	while (*format) {
-		int c = *format++;
+		int c;
 		char sign = 0;
 
-		/* Copy normal characters */
-		if (c != '%') {
-			if (addchar(context, c))
-				return EC_ERROR_OVERFLOW;
-			continue;
-		}
+		/* Copy normal characters, as many as possible at once */
+		run = format;
+		while (*format && *format != '%')
+			format++;
+		if (emit(&out, run, format - run))
+			return EC_ERROR_OVERFLOW;
+		if (!*format)
+			break;
+		format++;
 
 		/* Zero flags, now that we're in a format */
 		flags = 0;
@@ -135,7 +284,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 
 		/* Send "%" for "%%" input */
 		if (c == '%' || c == '\0') {
-			if (addchar(context, '%'))
+			if (emit(&out, "%", 1))
 				return EC_ERROR_OVERFLOW;
 
 			if (c == '\0')
@@ -215,11 +364,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 
 		} else {
 			int base = 10;
-#ifdef NO_UINT64_SUPPORT
-			uint32_t v;
-#else
-			uint64_t v;
-#endif
+			printf_uint_t v;
 			int ptrspec;
 			void *ptrval;
 
@@ -296,8 +441,7 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 						ptrval;
 					int rc;
 
-					rc = print_hex_buffer(addchar,
-							      context,
+					rc = print_hex_buffer(&out,
 							      hexbuf->buffer,
 							      hexbuf->size,
 							      0,
@@ -397,24 +541,13 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 			 * Handle digits to right of decimal for fixed point
 			 * numbers.
 			 */
-			for (vlen = 0; vlen < precision; vlen++)
-				*(--vstr) = '0' + divmod(&v, 10);
-			if (precision >= 0)
+			if (precision >= 0) {
+				vstr = format_fraction(vstr, &v, precision);
 				*(--vstr) = '.';
-
-			if (!v)
-				*(--vstr) = '0';
-
-			while (v) {
-				int digit = divmod(&v, base);
-				if (digit < 10)
-					*(--vstr) = '0' + digit;
-				else if (c == 'X')
-					*(--vstr) = 'A' + digit - 10;
-				else
-					*(--vstr) = 'a' + digit - 10;
 			}
 
+			vstr = format_uint(vstr, v, base, c == 'X');
+
 			if (sign)
 				*(--vstr) = sign;
 
@@ -432,7 +565,6 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		if (precision < 0) {
 			/* If precision is unset, print everything */
 			vlen = strlen(vstr);
-			precision = MAX(vlen, pad_width);
 		} else {
 			/*
 			 * If precision is set, ensure that we do not
@@ -441,26 +573,26 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 			vlen = strnlen(vstr, precision);
 		}
 
-
-		while (vlen < pad_width && !(flags & PF_LEFT)) {
-			if (addchar(context, flags & PF_PADZERO ? '0' : ' '))
-				return EC_ERROR_OVERFLOW;
-			vlen++;
-		}
-		while (--precision >= 0 && *vstr)
-			if (addchar(context, *vstr++))
-				return EC_ERROR_OVERFLOW;
-		while (vlen < pad_width && flags & PF_LEFT) {
-			if (addchar(context, ' '))
-				return EC_ERROR_OVERFLOW;
-			vlen++;
-		}
+		if (!(flags & PF_LEFT) &&
+		    emit_pad(&out, flags & PF_PADZERO ? '0' : ' ',
+			     pad_width - vlen))
+			return EC_ERROR_OVERFLOW;
+		if (emit(&out, vstr, vlen))
+			return EC_ERROR_OVERFLOW;
+		if ((flags & PF_LEFT) && emit_pad(&out, ' ', pad_width - vlen))
+			return EC_ERROR_OVERFLOW;
 	}
 
 	/* If we're still here, we consumed all output */
 	return EC_SUCCESS;
 }
 
+int vfnprintf(int (*addchar)(void *context, int c), void *context,
+	      const char *format, va_list args)
+{
+	return vfnprintf_str(addchar, NULL, context, format, args);
+}
+
 /* Context for snprintf() */
 struct snprintf_context {
 	char *str;
@@ -486,6 +618,25 @@ static int snprintf_addchar(void *context, int c)
 	return 0;
 }
 
+/**
+ * Add characters to the string context.
+ *
+ * @param context	Context receiving characters
+ * @param str		Characters to add
+ * @param len		Number of characters to add
+ * @return 0 if all characters added, 1 if some dropped because no space.
+ */
+static int snprintf_addstr(void *context, const char *str, int len)
+{
+	struct snprintf_context *ctx = (struct snprintf_context *)context;
+	int n = MIN(len, ctx->size);
+
+	memcpy(ctx->str, str, n);
+	ctx->str += n;
+	ctx->size -= n;
+	return n != len;
+}
+
 int snprintf(char *str, int size, const char *format, ...)
 {
 	va_list args;
@@ -509,7 +660,8 @@ int vsnprintf(char *str, int size, const char *format, va_list args)
 	ctx.str = str;
 	ctx.size = size - 1;  /* Reserve space for terminating '\0' */
 
-	rv = vfnprintf(snprintf_addchar, &ctx, format, args);
+	rv = vfnprintf_str(snprintf_addchar, snprintf_addstr, &ctx, format,
+			   args);
 
 	/* Terminate string */
 	*ctx.str = '\0';
@@ -19,6 +19,24 @@ struct queue_policy const queue_policy_null = {
 	.remove = queue_action_null,
 };
 
+/*
+ * Read the index owned by the other side of the queue.  Anything that side
+ * did to the buffer before publishing the index is visible once we see it.
+ */
+static inline size_t queue_load_index(size_t volatile *index)
+{
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Publish a new value for the index owned by this side of the queue, after
+ * all of our accesses to the units it covers have completed.
+ */
+static inline void queue_store_index(size_t volatile *index, size_t value)
+{
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
 void queue_init(struct queue const *q)
 {
 	ASSERT(q->policy);
@@ -31,12 +49,13 @@ void queue_init(struct queue const *q)
 
 int queue_is_empty(struct queue const *q)
 {
-	return q->state->head == q->state->tail;
+	return queue_count(q) == 0;
 }
 
 size_t queue_count(struct queue const *q)
 {
-	return q->state->tail - q->state->head;
+	return queue_load_index(&q->state->tail) -
+		queue_load_index(&q->state->head);
 }
 
 size_t queue_space(struct queue const *q)
@@ -72,13 +91,15 @@ int queue_is_full(struct queue const *q)
 
 struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = (q->state->tail + offset) & q->buffer_units_mask;
+	size_t head_index = queue_load_index(&q->state->head);
+	size_t tail_index = q->state->tail;
+	size_t head = head_index & q->buffer_units_mask;
+	size_t tail = (tail_index + offset) & q->buffer_units_mask;
 	size_t last = (tail < head) ? head :   /* Wrapped        */
 			q->buffer_units;       /* Normal | Empty */
 
 	/* Make sure that the offset doesn't exceed free space. */
-	if (queue_space(q) <= offset)
+	if (q->buffer_units - (tail_index - head_index) <= offset)
 		return ((struct queue_chunk) {
 			.count = 0,
 			.buffer = NULL,
@@ -92,9 +113,11 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset)
 
 struct queue_chunk queue_get_read_chunk(struct queue const *q)
 {
-	size_t head = q->state->head & q->buffer_units_mask;
-	size_t tail = q->state->tail & q->buffer_units_mask;
-	size_t last = (queue_is_empty(q) ? head : /* Empty          */
+	size_t head_index = q->state->head;
+	size_t tail_index = queue_load_index(&q->state->tail);
+	size_t head = head_index & q->buffer_units_mask;
+	size_t tail = tail_index & q->buffer_units_mask;
+	size_t last = ((head_index == tail_index) ? head : /* Empty   */
 		       ((head < tail) ? tail :    /* Normal         */
 			q->buffer_units));        /* Wrapped | Full */
 
@@ -104,11 +127,50 @@ struct queue_chunk queue_get_read_chunk(struct queue const *q)
 	});
 }
 
+/*
+ * Split count units starting at the (unwrapped) index start into the part
+ * before the end of the buffer and the part that wraps around to the start.
+ */
+static size_t queue_split_chunks(struct queue const *q,
+				 size_t start,
+				 size_t count,
+				 struct queue_chunk chunks[2])
+{
+	size_t index = start & q->buffer_units_mask;
+	size_t first = MIN(count, q->buffer_units - index);
+
+	chunks[0].count = first;
+	chunks[0].buffer = first ? q->buffer + index * q->unit_bytes : NULL;
+	chunks[1].count = count - first;
+	chunks[1].buffer = (count - first) ? q->buffer : NULL;
+
+	return count;
+}
+
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2])
+{
+	size_t head = queue_load_index(&q->state->head);
+	size_t tail = q->state->tail;
+
+	return queue_split_chunks(q, tail, q->buffer_units - (tail - head),
+				  chunks);
+}
+
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2])
+{
+	size_t head = q->state->head;
+	size_t tail = queue_load_index(&q->state->tail);
+
+	return queue_split_chunks(q, head, tail - head, chunks);
+}
+
 size_t queue_advance_head(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_count(q));
 
-	q->state->head += transfer;
+	queue_store_index(&q->state->head, q->state->head + transfer);
 
 	q->policy->remove(q->policy, transfer);
 
@@ -119,7 +181,7 @@ size_t queue_advance_tail(struct queue const *q, size_t count)
 {
 	size_t transfer = MIN(count, queue_space(q));
 
-	q->state->tail += transfer;
+	queue_store_index(&q->state->tail, q->state->tail + transfer);
 
 	q->policy->add(q->policy, transfer);
 
@@ -261,7 +323,7 @@ void queue_begin(struct queue const *q, struct queue_iterator *it)
 			q->unit_bytes;
 	it->_state.offset = 0;
 	it->_state.head = q->state->head;
-	it->_state.tail = q->state->tail;
+	it->_state.tail = queue_load_index(&q->state->tail);
 }
 
 void queue_next(struct queue const *q, struct queue_iterator *it)
@@ -55,12 +55,24 @@ static void mont_mul_add(const struct rsa_public_key *key,
 	uint64_t B = mula32(d0, key->n[0], A);
 	uint32_t i;
 
-	for (i = 1; i < RSANUMWORDS; ++i) {
+	/*
+	 * Two words per iteration; RSANUMWORDS is even, so this leaves the last
+	 * word for the tail below.
+	 */
+	for (i = 1; i < RSANUMWORDS - 1; i += 2) {
 		A = mulaa32(a, b[i], c[i], A >> 32);
 		B = mulaa32(d0, key->n[i], A, B >> 32);
 		c[i - 1] = (uint32_t)B;
+		A = mulaa32(a, b[i + 1], c[i + 1], A >> 32);
+		B = mulaa32(d0, key->n[i + 1], A, B >> 32);
+		c[i] = (uint32_t)B;
 	}
 
+	A = mulaa32(a, b[i], c[i], A >> 32);
+	B = mulaa32(d0, key->n[i], A, B >> 32);
+	c[i - 1] = (uint32_t)B;
+	i++;
+
 	A = (A >> 32) + (B >> 32);
 
 	c[i - 1] = (uint32_t)A;
@@ -69,42 +81,6 @@ static void mont_mul_add(const struct rsa_public_key *key,
 		sub_mod(key, c);
 }
 
-#ifdef CONFIG_RSA_EXPONENT_3
-/**
- * Montgomery c[] += 0 * b[] / R % mod
- */
-static void mont_mul_add_0(const struct rsa_public_key *key,
-			 uint32_t *c,
-			 const uint32_t *b)
-{
-	uint32_t d0 = c[0] * key->n0inv;
-	uint64_t B = mula32(d0, key->n[0], c[0]);
-	uint32_t i;
-
-	for (i = 1; i < RSANUMWORDS; ++i) {
-		B = mulaa32(d0, key->n[i], c[i], B >> 32);
-		c[i - 1] = (uint32_t)B;
-	}
-
-	c[i - 1] = B >> 32;
-}
-
-/* Montgomery c[] = a[] * 1 / R % key. */
-static void mont_mul_1(const struct rsa_public_key *key,
-		       uint32_t *c,
-		       const uint32_t *a)
-{
-	int i;
-
-	for (i = 0; i < RSANUMWORDS; ++i)
-		c[i] = 0;
-
-	mont_mul_add(key, c, 1, a);
-	for (i = 1; i < RSANUMWORDS; ++i)
-		mont_mul_add_0(key, c, a);
-}
-#endif
-
 /**
  * Montgomery c[] = a[] * b[] / R % mod
  */
@@ -129,14 +105,16 @@ static void mont_mul(const struct rsa_public_key *key,
  * @param inout		Input and output big-endian byte array
  * @param workbuf32	Work buffer; caller must verify this is
  *			3 x RSANUMWORDS elements long.
+ * @return EC_SUCCESS, or EC_ERROR_INVAL if the input is not less than the
+ *	   modulus, which no valid signature can be.
  */
-static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
-		    uint32_t *workbuf32)
+static int mod_pow(const struct rsa_public_key *key, uint8_t *inout,
+		   uint32_t *workbuf32)
 {
 	uint32_t *a = workbuf32;
 	uint32_t *a_r = a + RSANUMWORDS;
 	uint32_t *aa_r = a_r + RSANUMWORDS;
-	uint32_t *aaa = aa_r;  /* Re-use location. */
+	uint32_t *aaa;
 	int i;
 
 	/* Convert from big endian byte array to little endian word array. */
@@ -149,22 +127,35 @@ static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
 		a[i] = tmp;
 	}
 
-	/* TODO(drinkcat): This operation could be precomputed to save time. */
-	mont_mul(key, a_r, a, key->rr);  /* a_r = a * RR / R mod M */
+	if (ge_mod(key, a))
+		return EC_ERROR_INVAL;
+
+	/*
+	 * The per-key parts of the Montgomery setup (n0inv and RR = R^2 mod M)
+	 * come precomputed with the key; what is left depends on the
+	 * signature, so each exponent uses the shortest chain of
+	 * multiplications which takes it into and back out of Montgomery form.
+	 */
 #ifdef CONFIG_RSA_EXPONENT_3
-	mont_mul(key, aa_r, a_r, a_r);
-	mont_mul(key, a, aa_r, a_r);
-	mont_mul_1(key, aaa, a);
+	mont_mul(key, a_r, a, key->rr); /* a_r = a * RR / R = a * R mod M */
+	mont_mul(key, aa_r, a_r, a_r);  /* aa_r = a^2 * R mod M */
+	mont_mul(key, a_r, aa_r, a);    /* a_r = a^3 * R / R = a^3 mod M */
+	aaa = a_r;
 #else
 	/* Exponent 65537 */
+	mont_mul(key, a_r, a, key->rr);  /* a_r = a * RR / R mod M */
 	for (i = 0; i < 16; i += 2) {
 		mont_mul(key, aa_r, a_r, a_r); /* aa_r = a_r * a_r / R mod M */
 		mont_mul(key, a_r, aa_r, aa_r);/* a_r = aa_r * aa_r / R mod M */
 	}
-	mont_mul(key, aaa, a_r, a);  /* aaa = a_r * a / R mod M */
+	mont_mul(key, aa_r, a_r, a);  /* aa_r = a_r * a / R mod M */
+	aaa = aa_r;
 #endif
 
-	/* Make sure aaa < mod; aaa is at most 1x mod too large. */
+	/*
+	 * Make sure aaa < mod; the last multiplication was by a < mod, so aaa
+	 * is at most 1x mod too large.
+	 */
 	if (ge_mod(key, aaa))
 		sub_mod(key, aaa);
 
@@ -176,6 +167,8 @@ static void mod_pow(const struct rsa_public_key *key, uint8_t *inout,
 		*inout++ = (uint8_t)(tmp >>  8);
 		*inout++ = (uint8_t)(tmp >>  0);
 	}
+
+	return EC_SUCCESS;
 }
 
 /*
@@ -245,7 +238,9 @@ int rsa_verify(const struct rsa_public_key *key, const uint8_t *signature,
 	/* Copy input to local workspace. */
 	memcpy(buf, signature, RSANUMBYTES);
 
-	mod_pow(key, buf, workbuf32); /* In-place exponentiation. */
+	/* In-place exponentiation. */
+	if (mod_pow(key, buf, workbuf32) != EC_SUCCESS)
+		return 0;
 
 	/* Check the PKCS#1 padding */
 	if (check_padding(buf) != 0)
@@ -257,3 +252,24 @@ int rsa_verify(const struct rsa_public_key *key, const uint8_t *signature,
 
 	return 1;  /* All checked out OK. */
 }
+
+uint32_t rsa_verify_batch(const struct rsa_public_key *key, int count,
+			  const uint8_t * const *signatures,
+			  const uint8_t * const *shas, uint32_t *workbuf32)
+{
+	uint32_t good = 0;
+	int i;
+
+	/*
+	 * Each signature gets its own exponentiation.  Screening a product of
+	 * the signatures against a product of the padded digests would be
+	 * cheaper, but it can be fooled by two bad signatures whose errors
+	 * cancel out, so it is no use for images which may be attacker
+	 * supplied.
+	 */
+	for (i = 0; i < MIN(count, 32); i++)
+		if (rsa_verify(key, signatures[i], shas[i], workbuf32))
+			good |= BIT(i);
+
+	return good;
+}
@@ -37,6 +37,11 @@ TEST_GLOBAL struct shm_buffer *allocced_buf_chain;
 /* The size of the biggest ever allocated buffer. */
 static int max_allocated_size;
 
+/* Bytes in allocated buffers, now and at most, and failed allocations */
+static size_t allocated_bytes;
+static size_t max_allocated_bytes;
+static int failed_count;
+
 static void shared_mem_init(void)
 {
 	/*
@@ -95,6 +100,7 @@ static void do_release(struct shm_buffer *ptr)
 	 * for quick reference.
 	 */
 	released_size = ptr->buffer_size;
+	allocated_bytes -= released_size;
 	if (!free_buf_chain) {
 		/*
 		 * All memory had been allocated - this buffer is going to be
@@ -334,6 +340,12 @@ int shared_mem_acquire(int size, char **dest_ptr)
 
 		if (size > max_allocated_size)
 			max_allocated_size = size;
+
+		allocated_bytes += new_buf->buffer_size;
+		if (allocated_bytes > max_allocated_bytes)
+			max_allocated_bytes = allocated_bytes;
+	} else {
+		failed_count++;
 	}
 	mutex_unlock(&shmem_lock);
 
@@ -357,9 +369,10 @@ static int command_shmem(int argc, char **argv)
 	size_t allocated_size;
 	size_t free_size;
 	size_t max_free;
+	int free_bufs;
 	struct shm_buffer *buf;
 
-	allocated_size = free_size = max_free = 0;
+	allocated_size = free_size = max_free = free_bufs = 0;
 
 	mutex_lock(&shmem_lock);
 
@@ -371,6 +384,7 @@ static int command_shmem(int argc, char **argv)
 		free_size += buf_room;
 		if (buf_room > max_free)
 			max_free = buf_room;
+		free_bufs++;
 	}
 
 	for (buf = allocced_buf_chain; buf;
@@ -384,6 +398,11 @@ static int command_shmem(int argc, char **argv)
 	ccprintf("Free:          %6zd\n", free_size);
 	ccprintf("Max free buf:  %6zd\n", max_free);
 	ccprintf("Max allocated: %6d\n", max_allocated_size);
+	ccprintf("High water:    %6zd\n", max_allocated_bytes);
+	ccprintf("Free bufs:     %6d\n", free_bufs);
+	ccprintf("Fragmentation: %6d%%\n",
+		 free_size ? 100 - (int)(max_free * 100 / free_size) : 0);
+	ccprintf("Failed allocs: %6d\n", failed_count);
 	return EC_SUCCESS;
 }
 DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
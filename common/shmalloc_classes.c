@@ -0,0 +1,360 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Segregated-fit malloc/free memory module for Chrome EC.
+ *
+ * Free blocks are kept in one list per power-of-two size class, with a bitmap
+ * of the classes which have any free blocks.  An allocation looks through the
+ * list for its own size class, and failing that takes the first block of the
+ * next non-empty class, found with a couple of bit operations, instead of
+ * walking every free block.  Every block also records the block physically
+ * below it, so a released block is merged with its free neighbours without a
+ * walk.
+ */
+#include <stdint.h>
+
+#include "common.h"
+#include "console.h"
+#include "hooks.h"
+#include "link_defs.h"
+#include "shared_mem.h"
+#include "system.h"
+#include "task.h"
+#include "util.h"
+
+/* Header at the start of every block, allocated or free */
+struct shm_block {
+	/* Block physically below this one, NULL for the first block */
+	struct shm_block *prev_phys;
+	/* Size of the block including the header; bit 0 set when in use */
+	size_t size;
+	/* Free list links, only present in free blocks */
+	struct shm_block *next_free;
+	struct shm_block *prev_free;
+};
+
+#define SHM_USED 1
+/* Allocated blocks only carry the first two fields */
+#define SHM_HEADER offsetof(struct shm_block, next_free)
+/* A free block must have room for its list links */
+#define SHM_MIN_BLOCK sizeof(struct shm_block)
+/* Block sizes and addresses are kept aligned to the header size */
+#define SHM_ALIGN SHM_HEADER
+/* Class n holds free blocks of [2^n, 2^(n+1)) bytes */
+#define SHM_CLASSES 32
+
+static struct mutex shmem_lock;
+
+static struct shm_block *free_lists[SHM_CLASSES];
+static uint32_t free_classes;
+
+static struct shm_block *heap_start;
+static uintptr_t heap_end;
+
+/* The size of the biggest ever allocated buffer. */
+static int max_allocated_size;
+
+/* Bytes in allocated blocks, now and at most, and failed allocations */
+static size_t allocated_bytes;
+static size_t max_allocated_bytes;
+static int failed_count;
+
+static inline size_t block_size(const struct shm_block *b)
+{
+	return b->size & ~SHM_USED;
+}
+
+static struct shm_block *next_phys(const struct shm_block *b)
+{
+	uintptr_t next = (uintptr_t)b + block_size(b);
+
+	return next < heap_end ? (struct shm_block *)next : NULL;
+}
+
+static inline int size_class(size_t size)
+{
+	return __fls((uint32_t)size);
+}
+
+static void free_list_insert(struct shm_block *b)
+{
+	int c = size_class(b->size);
+
+	b->prev_free = NULL;
+	b->next_free = free_lists[c];
+	if (b->next_free)
+		b->next_free->prev_free = b;
+	free_lists[c] = b;
+	free_classes |= BIT(c);
+}
+
+static void free_list_remove(struct shm_block *b)
+{
+	int c = size_class(b->size);
+
+	if (b->prev_free) {
+		b->prev_free->next_free = b->next_free;
+	} else {
+		free_lists[c] = b->next_free;
+		if (!free_lists[c])
+			free_classes &= ~BIT(c);
+	}
+	if (b->next_free)
+		b->next_free->prev_free = b->prev_free;
+}
+
+static struct shm_block *find_free_block(size_t size)
+{
+	int c = size_class(size);
+	uint32_t bigger = c + 1 < SHM_CLASSES ?
+		free_classes & (~0U << (c + 1)) : 0;
+	struct shm_block *b;
+
+	/* Prefer a block from the request's own class, to limit splitting */
+	for (b = free_lists[c]; b; b = b->next_free)
+		if (b->size >= size)
+			return b;
+
+	/* Otherwise any block from a higher class is big enough */
+	if (bigger)
+		return free_lists[__builtin_ctz(bigger)];
+
+	return NULL;
+}
+
+static void shared_mem_init(void)
+{
+	uintptr_t start = ((uintptr_t)__shared_mem_buf + SHM_ALIGN - 1) &
+		~(SHM_ALIGN - 1);
+
+	/*
+	 * Use all the RAM we can. The shared memory buffer is the last thing
+	 * allocated from the start of RAM, so we can use everything up to the
+	 * jump data at the end of RAM.
+	 */
+	heap_start = (struct shm_block *)start;
+	heap_end = system_usable_ram_end() & ~(SHM_ALIGN - 1);
+	heap_start->prev_phys = NULL;
+	heap_start->size = heap_end - start;
+	free_list_insert(heap_start);
+}
+DECLARE_HOOK(HOOK_INIT, shared_mem_init, HOOK_PRIO_FIRST);
+
+/* Called with the mutex lock acquired. */
+static struct shm_block *do_acquire(int size)
+{
+	size_t needed = (size + SHM_HEADER + SHM_ALIGN - 1) & ~(SHM_ALIGN - 1);
+	struct shm_block *b;
+	struct shm_block *rest;
+	struct shm_block *next;
+
+	needed = MAX(needed, SHM_MIN_BLOCK);
+
+	b = find_free_block(needed);
+	if (!b)
+		return NULL;
+	free_list_remove(b);
+
+	/* Give the tail back if it is big enough to be a block of its own */
+	if (b->size - needed >= SHM_MIN_BLOCK) {
+		rest = (struct shm_block *)((uintptr_t)b + needed);
+		rest->prev_phys = b;
+		rest->size = b->size - needed;
+		next = next_phys(rest);
+		if (next)
+			next->prev_phys = rest;
+		b->size = needed;
+		free_list_insert(rest);
+	}
+
+	b->size |= SHM_USED;
+	allocated_bytes += block_size(b);
+	if (allocated_bytes > max_allocated_bytes)
+		max_allocated_bytes = allocated_bytes;
+
+	return b;
+}
+
+/* Called with the mutex lock acquired. */
+static void do_release(struct shm_block *b)
+{
+	struct shm_block *next;
+	struct shm_block *prev;
+
+	/* Sanity check: ignore anything which isn't an allocated block. */
+	if (b < heap_start || (uintptr_t)b >= heap_end ||
+	    !(b->size & SHM_USED))
+		return;
+
+	b->size &= ~SHM_USED;
+	allocated_bytes -= b->size;
+
+	/* Merge with free neighbours on either side */
+	next = next_phys(b);
+	if (next && !(next->size & SHM_USED)) {
+		free_list_remove(next);
+		b->size += next->size;
+	}
+	prev = b->prev_phys;
+	if (prev && !(prev->size & SHM_USED)) {
+		free_list_remove(prev);
+		prev->size += b->size;
+		b = prev;
+	}
+	next = next_phys(b);
+	if (next)
+		next->prev_phys = b;
+
+	free_list_insert(b);
+}
+
+int shared_mem_size(void)
+{
+	struct shm_block *b;
+	size_t max_available = 0;
+
+	mutex_lock(&shmem_lock);
+
+	/* The biggest free block is in the highest non-empty class. */
+	if (free_classes)
+		for (b = free_lists[__fls(free_classes)]; b; b = b->next_free)
+			max_available = MAX(max_available, b->size);
+
+	mutex_unlock(&shmem_lock);
+
+	/* Leave room for shmem header */
+	return max_available ? max_available - SHM_HEADER : 0;
+}
+
+int shared_mem_acquire(int size, char **dest_ptr)
+{
+	struct shm_block *b;
+	int rv = EC_SUCCESS;
+
+	*dest_ptr = NULL;
+
+	if (in_interrupt_context())
+		return EC_ERROR_INVAL;
+
+	if (size < 0)
+		return EC_ERROR_INVAL;
+
+	mutex_lock(&shmem_lock);
+	b = do_acquire(size);
+	if (b) {
+		*dest_ptr = (char *)b + SHM_HEADER;
+		if (size > max_allocated_size)
+			max_allocated_size = size;
+	} else {
+		failed_count++;
+		rv = EC_ERROR_BUSY;
+	}
+	mutex_unlock(&shmem_lock);
+
+	return rv;
+}
+
+void shared_mem_release(void *ptr)
+{
+	if (in_interrupt_context())
+		return;
+
+	mutex_lock(&shmem_lock);
+	do_release((struct shm_block *)((char *)ptr - SHM_HEADER));
+	mutex_unlock(&shmem_lock);
+}
+
+#ifdef TEST_BUILD
+int shared_mem_check(void)
+{
+	struct shm_block *b;
+	struct shm_block *prev = NULL;
+	size_t total = 0;
+	int free_blocks = 0;
+	int listed = 0;
+	int rv = EC_SUCCESS;
+	int c;
+
+	mutex_lock(&shmem_lock);
+
+	for (b = heap_start; b; prev = b, b = next_phys(b)) {
+		if (b->prev_phys != prev || block_size(b) < SHM_MIN_BLOCK ||
+		    block_size(b) & (SHM_ALIGN - 1))
+			rv = EC_ERROR_UNKNOWN;
+		/* Free neighbours should always have been merged */
+		if (!(b->size & SHM_USED)) {
+			free_blocks++;
+			if (prev && !(prev->size & SHM_USED))
+				rv = EC_ERROR_UNKNOWN;
+		}
+		total += block_size(b);
+	}
+	if ((uintptr_t)heap_start + total != heap_end)
+		rv = EC_ERROR_UNKNOWN;
+
+	for (c = 0; c < SHM_CLASSES; c++) {
+		if (!(free_classes & BIT(c)) != !free_lists[c])
+			rv = EC_ERROR_UNKNOWN;
+		for (b = free_lists[c]; b; b = b->next_free) {
+			if (size_class(b->size) != c || b->size & SHM_USED ||
+			    (b->next_free && b->next_free->prev_free != b))
+				rv = EC_ERROR_UNKNOWN;
+			if (++listed > free_blocks)
+				break;
+		}
+	}
+	if (listed != free_blocks)
+		rv = EC_ERROR_UNKNOWN;
+
+	mutex_unlock(&shmem_lock);
+
+	return rv;
+}
+#endif
+
+#ifdef CONFIG_CMD_SHMEM
+
+static int command_shmem(int argc, char **argv)
+{
+	size_t allocated_size;
+	size_t free_size;
+	size_t max_free;
+	int free_blocks;
+	struct shm_block *b;
+
+	allocated_size = free_size = max_free = free_blocks = 0;
+
+	mutex_lock(&shmem_lock);
+
+	for (b = heap_start; b; b = next_phys(b)) {
+		if (b->size & SHM_USED) {
+			allocated_size += block_size(b);
+		} else {
+			free_size += b->size;
+			max_free = MAX(max_free, b->size);
+			free_blocks++;
+		}
+	}
+
+	mutex_unlock(&shmem_lock);
+
+	ccprintf("Total:         %6zd\n", allocated_size + free_size);
+	ccprintf("Allocated:     %6zd\n", allocated_size);
+	ccprintf("Free:          %6zd\n", free_size);
+	ccprintf("Max free buf:  %6zd\n", max_free);
+	ccprintf("Max allocated: %6d\n", max_allocated_size);
+	ccprintf("High water:    %6zd\n", max_allocated_bytes);
+	ccprintf("Free bufs:     %6d\n", free_blocks);
+	ccprintf("Fragmentation: %6d%%\n",
+		 free_size ? 100 - (int)(max_free * 100 / free_size) : 0);
+	ccprintf("Failed allocs: %6d\n", failed_count);
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(shmem, command_shmem,
+			     NULL,
+			     "Print shared memory stats");
+
+#endif  /* CONFIG_CMD_SHMEM */
@@ -156,6 +156,7 @@ int test_send_host_command(int command, int version, const void *params,
 	args.response = resp;
 	args.response_max = resp_size;
 	args.response_size = 0;
+	args.send_response = NULL;
 
 	return host_command_process(&args);
 }
@@ -7,6 +7,7 @@
 
 #include "atomic.h"
 #include "console.h"
+#include "deadline_heap.h"
 #include "hooks.h"
 #include "hwtimer.h"
 #include "system.h"
@@ -20,20 +21,32 @@
 /* High 32-bits of the 64-bit timestamp counter. */
 STATIC_IF_NOT(CONFIG_HWTIMER_64BIT) uint32_t clksrc_high;
 
-/* Bitmap of currently running timers */
-static uint32_t timer_running;
-
 /* Deadlines of all timers */
 static timestamp_t timer_deadline[TASK_ID_COUNT];
 static uint32_t next_deadline = 0xffffffff;
 
+/*
+ * Running timers, ordered by deadline so the next one to expire is always
+ * first.
+ *
+ * The heap is only changed from the timer interrupt, or with interrupts
+ * disabled.
+ */
+static uint8_t timer_heap_ids[TASK_ID_COUNT];
+static uint8_t timer_heap_pos[TASK_ID_COUNT];
+static struct deadline_heap timer_heap = {
+	.deadline = timer_deadline,
+	.heap = timer_heap_ids,
+	.pos = timer_heap_pos,
+};
+
 /* Hardware timer routine IRQ number */
 static int timer_irq;
 
 static void expire_timer(task_id_t tskid)
 {
 	/* we are done with this timer */
-	atomic_clear(&timer_running, 1 << tskid);
+	deadline_heap_remove(&timer_heap, tskid);
 	/* wake up the taks waiting for this timer */
 	task_set_event(tskid, TASK_EVENT_TIMER, 0);
 }
@@ -52,43 +65,33 @@ int timestamp_expired(timestamp_t deadline, const timestamp_t *now)
 
 void process_timers(int overflow)
 {
-	uint32_t check_timer, running_t0;
 	timestamp_t next;
 	timestamp_t now;
+	int first;
 
 	if (!IS_ENABLED(CONFIG_HWTIMER_64BIT) && overflow)
 		clksrc_high++;
 
 	do {
-		next.val = -1ull;
 		now = get_time();
-		do {
-			/* read atomically the current state of timer running */
-			check_timer = running_t0 = timer_running;
-			while (check_timer) {
-
-				int tskid = __fls(check_timer);
-				/* timer has expired ? */
-				if (timer_deadline[tskid].val <= now.val)
-					expire_timer(tskid);
-				else if ((timer_deadline[tskid].le.hi ==
-					  now.le.hi) &&
-					 (timer_deadline[tskid].le.lo <
-					  next.le.lo))
-					next.val = timer_deadline[tskid].val;
-
-				check_timer &= ~BIT(tskid);
-			}
-		/* if there is a new timer, let's retry */
-		} while (timer_running & ~running_t0);
-
-		if (next.le.hi == 0xffffffff) {
-			/* no deadline to set */
+
+		/* Expired timers are all at the top of the heap */
+		while ((first = deadline_heap_first(&timer_heap)) >= 0 &&
+		       timer_deadline[first].val <= now.val)
+			expire_timer(first);
+
+		/*
+		 * Nothing to set if there are no timers, or if the next one is
+		 * past the next overflow of the low 32 bits (the overflow
+		 * interrupt will get us back here).
+		 */
+		if (first < 0 || timer_deadline[first].le.hi != now.le.hi) {
 			__hw_clock_event_clear();
 			next_deadline = 0xffffffff;
 			return;
 		}
 
+		next = timer_deadline[first];
 		__hw_clock_event_set(next.le.lo);
 		next_deadline = next.le.lo;
 	} while (next.val <= get_time().val);
@@ -120,11 +123,13 @@ int timer_arm(timestamp_t event, task_id_t tskid)
 
 	ASSERT(tskid < TASK_ID_COUNT);
 
-	if (timer_running & BIT(tskid))
+	if (deadline_heap_queued(&timer_heap, tskid))
 		return EC_ERROR_BUSY;
 
+	interrupt_disable();
 	timer_deadline[tskid] = event;
-	atomic_or(&timer_running, BIT(tskid));
+	deadline_heap_insert(&timer_heap, tskid);
+	interrupt_enable();
 
 	/* Modify the next event if needed */
 	if ((event.le.hi < now.le.hi) ||
@@ -138,7 +143,10 @@ void timer_cancel(task_id_t tskid)
 {
 	ASSERT(tskid < TASK_ID_COUNT);
 
-	atomic_clear(&timer_running, BIT(tskid));
+	interrupt_disable();
+	if (deadline_heap_queued(&timer_heap, tskid))
+		deadline_heap_remove(&timer_heap, tskid);
+	interrupt_enable();
 	/*
 	 * Don't need to cancel the hardware timer interrupt, instead do
 	 * timer-related housekeeping when the next timer interrupt fires.
@@ -243,7 +251,7 @@ void timer_print_info(void)
 	cflush();
 
 	for (tskid = 0; tskid < TASK_ID_COUNT; tskid++) {
-		if (timer_running & BIT(tskid)) {
+		if (deadline_heap_queued(&timer_heap, tskid)) {
 			ccprintf("  Tsk %2d  0x%016llx -> %11.6lld\n", tskid,
 				 timer_deadline[tskid].val,
 				 timer_deadline[tskid].val - t.val);
@@ -257,7 +265,7 @@ void timer_init(void)
 	const timestamp_t *ts;
 	int size, version;
 
-	BUILD_ASSERT(TASK_ID_COUNT < sizeof(timer_running) * 8);
+	BUILD_ASSERT(TASK_ID_COUNT <= UINT8_MAX);
 
 	/* Restore time from before sysjump */
 	ts = (const timestamp_t *)system_get_jump_tag(TIMER_SYSJUMP_TAG,
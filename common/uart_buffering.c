@@ -71,25 +71,18 @@ void uart_init_buffer(void)
 	}
 }
 
+#ifndef CONFIG_POLLING_UART
 /**
- * Put a single character into the transmit buffer.
- *
- * Does not enable the transmit interrupt; assumes that happens elsewhere.
+ * Store a single character in the transmit buffer, without updating the
+ * checksum.
  *
- * @param context	Context; ignored.
  * @param c		Character to write.
- * @return 0 if the character was transmitted, 1 if it was dropped.
+ * @return 0 if the character was stored, 1 if it was dropped.
  */
-static int __tx_char_raw(void *context, int c)
+static inline int tx_buf_put(int c)
 {
 	int tx_buf_next, tx_buf_new_tail;
 
-#if defined CONFIG_POLLING_UART
-	(void) tx_buf_next;
-	(void) tx_buf_new_tail;
-	uart_write_char(c);
-#else
-
 	tx_buf_next = TX_BUF_NEXT(tx_buf_head);
 	if (tx_buf_next == tx_buf_tail)
 		return 1;
@@ -112,6 +105,27 @@ static int __tx_char_raw(void *context, int c)
 	tx_buf[tx_buf_head] = c;
 	tx_buf_head = tx_buf_next;
 
+	return 0;
+}
+#endif
+
+/**
+ * Put a single character into the transmit buffer.
+ *
+ * Does not enable the transmit interrupt; assumes that happens elsewhere.
+ *
+ * @param context	Context; ignored.
+ * @param c		Character to write.
+ * @return 0 if the character was transmitted, 1 if it was dropped.
+ */
+static int __tx_char_raw(void *context, int c)
+{
+#if defined CONFIG_POLLING_UART
+	uart_write_char(c);
+#else
+	if (tx_buf_put(c))
+		return 1;
+
 	if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
 		tx_checksum = uart_buffer_calc_checksum();
 #endif
@@ -126,12 +140,84 @@ static int __tx_char(void *context, int c)
 	return __tx_char_raw(context, c);
 }
 
+/**
+ * Put several characters into the transmit buffer, translating '\n' to
+ * '\r\n'.
+ *
+ * With CONFIG_PRESERVE_LOGS the checksum is updated after every byte, as a
+ * reset part way through must not leave the preserved buffer looking
+ * corrupt.
+ *
+ * @param context	Context; ignored.
+ * @param str		Characters to write.
+ * @param len		Number of characters to write.
+ * @return 0 if all characters were transmitted, 1 if some were dropped.
+ */
+static int __tx_str(void *context, const char *str, int len)
+{
+	int rv = 0;
+
+#if defined CONFIG_POLLING_UART
+	for (; len; len--, str++) {
+		if (*str == '\n')
+			uart_write_char('\r');
+		uart_write_char(*str);
+	}
+#else
+	if (IS_ENABLED(CONFIG_PRESERVE_LOGS)) {
+		for (; len && !rv; len--, str++)
+			rv = __tx_char(NULL, *str);
+		return rv;
+	}
+
+	for (; len && !rv; len--, str++) {
+		if (*str == '\n')
+			rv = tx_buf_put('\r');
+		if (!rv)
+			rv = tx_buf_put(*str);
+	}
+#endif
+	return rv;
+}
+
+#ifdef CONFIG_CMD_UART_STATS
+/* Transmit statistics, since the last uartstats command */
+test_export_static uint32_t tx_stats_bytes;
+test_export_static uint32_t tx_stats_interrupts;
+static timestamp_t tx_stats_since;
+
+static inline void tx_stats_add(int bytes)
+{
+	tx_stats_bytes += bytes;
+}
+
+static inline void tx_stats_interrupt(void)
+{
+	tx_stats_interrupts++;
+}
+#else
+static inline void tx_stats_add(int bytes)
+{
+}
+
+static inline void tx_stats_interrupt(void)
+{
+}
+#endif
+
 #ifdef CONFIG_UART_TX_DMA
 
+__overridable int uart_tx_dma_start_spans(const char *src, int len,
+					  const char *next, int next_len)
+{
+	uart_tx_dma_start(src, len);
+	return len;
+}
+
 /**
  * Process UART output via DMA
  */
-void uart_process_output(void)
+static void __process_output(void)
 {
 	/* Size of current DMA transfer */
 	static int tx_dma_in_progress;
@@ -150,6 +236,7 @@ void uart_process_output(void)
 	if (tx_dma_in_progress) {
 		tx_buf_tail = (tx_buf_tail + tx_dma_in_progress) &
 			(CONFIG_UART_TX_BUF_SIZE - 1);
+		tx_stats_add(tx_dma_in_progress);
 		tx_dma_in_progress = 0;
 
 		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
@@ -163,27 +250,36 @@ void uart_process_output(void)
 	}
 
 	/*
-	 * Get the largest contiguous block of output.  If the transmit buffer
-	 * wraps, only use the part before the wrap.
+	 * Send all the output.  If the transmit buffer wraps, the part after
+	 * the wrap goes as a second span, if the chip can queue one.
 	 */
-	tx_dma_in_progress = (head > tx_buf_tail ? head :
-			      CONFIG_UART_TX_BUF_SIZE) - tx_buf_tail;
-
-	uart_tx_dma_start((char *)(tx_buf + tx_buf_tail), tx_dma_in_progress);
+	if (head > tx_buf_tail)
+		tx_dma_in_progress = uart_tx_dma_start_spans(
+				(char *)(tx_buf + tx_buf_tail),
+				head - tx_buf_tail, NULL, 0);
+	else
+		tx_dma_in_progress = uart_tx_dma_start_spans(
+				(char *)(tx_buf + tx_buf_tail),
+				CONFIG_UART_TX_BUF_SIZE - tx_buf_tail,
+				(char *)tx_buf, head);
 }
 
 #else /* !CONFIG_UART_TX_DMA */
 
-void uart_process_output(void)
+static void __process_output(void)
 {
+	int sent = 0;
+
 	/* Copy output from buffer until TX fifo full or output buffer empty */
 	while (uart_tx_ready() && (tx_buf_head != tx_buf_tail)) {
 		uart_write_char(tx_buf[tx_buf_tail]);
 		tx_buf_tail = TX_BUF_NEXT(tx_buf_tail);
+		sent++;
 
 		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
 			tx_checksum = uart_buffer_calc_checksum();
 	}
+	tx_stats_add(sent);
 
 	/* If output buffer is empty, disable transmit interrupt */
 	if (tx_buf_tail == tx_buf_head)
@@ -192,6 +288,13 @@ void uart_process_output(void)
 
 #endif /* !CONFIG_UART_TX_DMA */
 
+void uart_process_output(void)
+{
+	/* Only the UART interrupt handlers come through here */
+	tx_stats_interrupt();
+	__process_output();
+}
+
 #ifdef CONFIG_UART_RX_DMA
 #ifdef CONFIG_UART_INPUT_FILTER  /* TODO(crosbug.com/p/36745): */
 #error "Filtering the UART input with DMA enabled is NOT SUPPORTED!"
@@ -277,29 +380,18 @@ int uart_putc(int c)
 int uart_puts(const char *outstr)
 {
 	/* Put all characters in the output buffer */
-	while (*outstr) {
-		if (__tx_char(NULL, *outstr++) != 0)
-			break;
-	}
-
-	uart_tx_start();
-
-	/* Successful if we consumed all output */
-	return *outstr ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return uart_put(outstr, strlen(outstr));
 }
 
 int uart_put(const char *out, int len)
 {
 	/* Put all characters in the output buffer */
-	while (len--) {
-		if (__tx_char(NULL, *out++) != 0)
-			break;
-	}
+	int rv = __tx_str(NULL, out, len);
 
 	uart_tx_start();
 
 	/* Successful if we consumed all output */
-	return len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return rv ? EC_ERROR_OVERFLOW : EC_SUCCESS;
 }
 
 int uart_put_raw(const char *out, int len)
@@ -318,7 +410,7 @@ int uart_put_raw(const char *out, int len)
 
 int uart_vprintf(const char *format, va_list args)
 {
-	int rv = vfnprintf(__tx_char, NULL, format, args);
+	int rv = vfnprintf_str(__tx_char, __tx_str, NULL, format, args);
 
 	uart_tx_start();
 
@@ -350,7 +442,7 @@ void uart_flush_output(void)
 			 * interrupt may not be able to preempt the interrupt
 			 * we're in now.
 			 */
-			uart_process_output();
+			__process_output();
 		} else {
 			/*
 			 * It's possible we switched from a previous context
@@ -522,3 +614,40 @@ int uart_console_read_buffer(uint8_t type,
 
 	return EC_RES_SUCCESS;
 }
+
+#ifdef CONFIG_CMD_UART_STATS
+static int command_uart_stats(int argc, char **argv)
+{
+	uint32_t bytes, interrupts;
+	uint64_t elapsed_ms;
+	uint64_t bytes_per_sec;
+	uint64_t ints_per_sec;
+	timestamp_t now = get_time();
+
+	/* Snapshot and start a new measurement window */
+	interrupt_disable();
+	bytes = tx_stats_bytes;
+	interrupts = tx_stats_interrupts;
+	tx_stats_bytes = 0;
+	tx_stats_interrupts = 0;
+	interrupt_enable();
+
+	elapsed_ms = now.val - tx_stats_since.val;
+	tx_stats_since = now;
+	bytes_per_sec = (uint64_t)bytes * MSEC;
+	ints_per_sec = (uint64_t)interrupts * MSEC;
+
+	uint64divmod(&elapsed_ms, MSEC);
+	elapsed_ms = MAX(elapsed_ms, 1);
+	uint64divmod(&bytes_per_sec, (int)MIN(elapsed_ms, INT32_MAX));
+	uint64divmod(&ints_per_sec, (int)MIN(elapsed_ms, INT32_MAX));
+
+	ccprintf("TX bytes:      %u (%u/s)\n", bytes, (uint32_t)bytes_per_sec);
+	ccprintf("TX interrupts: %u (%u/s)\n", interrupts,
+		 (uint32_t)ints_per_sec);
+	ccprintf("Bytes per int: %u\n", interrupts ? bytes / interrupts : 0);
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(uartstats, command_uart_stats, NULL,
+			     "Print and reset UART transmit statistics");
+#endif /* CONFIG_CMD_UART_STATS */
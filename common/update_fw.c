@@ -17,6 +17,7 @@
 #include "util.h"
 #include "vb21_struct.h"
 #include "vboot.h"
+#include "vboot_hash.h"
 
 #if defined(CONFIG_TOUCHPAD_VIRTUAL_OFF) && defined(CONFIG_TOUCHPAD_HASH_FW)
 #define CONFIG_TOUCHPAD_FW_CHUNKS \
@@ -80,6 +81,7 @@ static uint8_t check_update_chunk(uint32_t block_offset, size_t body_size)
 		 * be erased.
 		 */
 		if (block_offset == base) {
+			vboot_hash_cache_invalidate(base, size);
 			if (flash_physical_erase(base, size) != EC_SUCCESS) {
 				CPRINTF("%s:%d erase failure of 0x%x..+0x%x\n",
 					__func__, __LINE__, base, size);
@@ -300,6 +302,7 @@ void fw_update_command_handler(void *body,
 #endif
 
 	CPRINTF("update: 0x%x\n", block_offset + CONFIG_PROGRAM_MEMORY_BASE);
+	vboot_hash_cache_invalidate(block_offset, body_size);
 	if (flash_physical_write(block_offset, body_size, update_data)
 	    != EC_SUCCESS) {
 		*error_code = UPDATE_WRITE_FAILURE;
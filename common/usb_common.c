@@ -68,6 +68,7 @@ int remote_flashing(int argc, char **argv)
 {
 	int port, cnt, cmd;
 	uint32_t data[VDO_MAX_SIZE-1];
+	uint32_t __maybe_unused events = 0;
 	char *e;
 	static int flash_offset[CONFIG_USB_PD_PORT_MAX_COUNT];
 
@@ -113,7 +114,16 @@ int remote_flashing(int argc, char **argv)
 
 	/* Wait until VDM is done */
 	while (pd[port].vdm_state > 0)
-		task_wait_event(100*MSEC);
+		events |= task_wait_event(100*MSEC);
+
+#ifdef CONFIG_USB_PD_SHARED_TASK
+	/*
+	 * If this ran on the shared PD task, the wait above consumed the
+	 * wakeup of any port which got events meanwhile. Post it again.
+	 */
+	if (events & PD_EVENT_PORT_PENDING)
+		task_set_event(task_get_current(), PD_EVENT_PORT_PENDING, 0);
+#endif
 
 	ccprintf("DONE %d\n", pd[port].vdm_state);
 	return EC_SUCCESS;
@@ -459,7 +469,7 @@ void usb_mux_set_safe_mode(int port)
 
 static void pd_send_hard_reset(int port)
 {
-	task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_SEND_HARD_RESET, 0);
+	pd_task_set_event(port, PD_EVENT_SEND_HARD_RESET);
 }
 
 #ifdef CONFIG_USBC_PPC
@@ -26,6 +26,7 @@
 #include "usb_mux.h"
 #include "usb_pd.h"
 #include "usbc_ppc.h"
+#include "vboot_hash.h"
 #include "version.h"
 
 #ifdef CONFIG_COMMON_RUNTIME
@@ -924,6 +925,7 @@ int pd_custom_flash_vdm(int port, int cnt, uint32_t *payload)
 		pd_log_event(PD_EVENT_ACC_RW_ERASE, 0, 0, NULL);
 		flash_offset = CONFIG_EC_WRITABLE_STORAGE_OFF +
 			       CONFIG_RW_STORAGE_OFF;
+		vboot_hash_cache_invalidate(flash_offset, CONFIG_RW_SIZE);
 		flash_physical_erase(CONFIG_EC_WRITABLE_STORAGE_OFF +
 				     CONFIG_RW_STORAGE_OFF, CONFIG_RW_SIZE);
 		rw_flash_changed = 1;
@@ -934,6 +936,7 @@ int pd_custom_flash_vdm(int port, int cnt, uint32_t *payload)
 		    (flash_offset < CONFIG_EC_WRITABLE_STORAGE_OFF +
 				    CONFIG_RW_STORAGE_OFF))
 			break;
+		vboot_hash_cache_invalidate(flash_offset, 4*(cnt - 1));
 		flash_physical_write(flash_offset, 4*(cnt - 1),
 				     (const char *)(payload+1));
 		flash_offset += 4*(cnt - 1);
@@ -945,6 +948,8 @@ int pd_custom_flash_vdm(int port, int cnt, uint32_t *payload)
 			uint32_t zero = 0;
 			int offset;
 			/* zeroes the area containing the RSA signature */
+			vboot_hash_cache_invalidate(FW_RW_END - RSANUMBYTES,
+						    RSANUMBYTES);
 			for (offset = FW_RW_END - RSANUMBYTES;
 			     offset < FW_RW_END; offset += 4)
 				flash_physical_write(offset, 4,
@@ -174,6 +174,12 @@ test_export_static int command_pd(int argc, char **argv)
 				pe_get_flags(port));
 		else
 			ccprintf("\n");
+
+		if (IS_ENABLED(CONFIG_USB_PD_STATE_PROFILE)) {
+			tc_print_state_profile(port);
+			if (IS_ENABLED(CONFIG_USB_PE_SM))
+				pe_print_state_profile(port);
+		}
 	}
 
 	return EC_SUCCESS;
@@ -93,19 +93,11 @@ void dpm_vdm_naked(int port, enum tcpm_transmit_type type, uint16_t svid,
 	}
 }
 
-/*
- * The call to this function requests that the PE send one VDM, whichever is
- * next in the mode entry sequence. This only happens if preconditions for mode
- * entry are met.
- */
-static void dpm_attempt_mode_entry(int port)
+/* Return true if the preconditions for mode entry are met */
+static bool dpm_mode_entry_allowed(int port)
 {
-	int vdo_count = 0;
-	uint32_t vdm[VDO_MAX_SIZE];
-	enum tcpm_transmit_type tx_type = TCPC_TX_SOP;
-
 	if (pd_get_data_role(port) != PD_ROLE_DFP)
-		return;
+		return false;
 	/*
 	 * Do not try to enter mode while CPU is off.
 	 * CPU transitions (e.g b/158634281) can occur during the discovery
@@ -114,13 +106,27 @@ static void dpm_attempt_mode_entry(int port)
 	 * enter the mode to fail prematurely.
 	 */
 	if (chipset_in_or_transitioning_to_state(CHIPSET_STATE_ANY_OFF))
-		return;
+		return false;
 	/*
 	 * If discovery has not occurred for modes, do not attempt to switch
 	 * to alt mode.
 	 */
-	if (pd_get_svids_discovery(port, TCPC_TX_SOP) != PD_DISC_COMPLETE ||
-	    pd_get_modes_discovery(port, TCPC_TX_SOP) != PD_DISC_COMPLETE)
+	return pd_get_svids_discovery(port, TCPC_TX_SOP) == PD_DISC_COMPLETE &&
+	       pd_get_modes_discovery(port, TCPC_TX_SOP) == PD_DISC_COMPLETE;
+}
+
+/*
+ * The call to this function requests that the PE send one VDM, whichever is
+ * next in the mode entry sequence. This only happens if preconditions for mode
+ * entry are met.
+ */
+static void dpm_attempt_mode_entry(int port)
+{
+	int vdo_count = 0;
+	uint32_t vdm[VDO_MAX_SIZE];
+	enum tcpm_transmit_type tx_type = TCPC_TX_SOP;
+
+	if (!dpm_mode_entry_allowed(port))
 		return;
 
 	/* Check if the device and cable support USB4. */
@@ -214,3 +220,9 @@ void dpm_run(int port)
 	else if (!dpm[port].mode_entry_done)
 		dpm_attempt_mode_entry(port);
 }
+
+bool dpm_has_work(int port)
+{
+	return dpm[port].mode_exit_request ||
+	       (!dpm[port].mode_entry_done && dpm_mode_entry_allowed(port));
+}
@@ -742,6 +742,9 @@ static struct policy_engine {
 test_export_static enum usb_pe_state get_state_pe(const int port);
 test_export_static void set_state_pe(const int port,
 				     const enum usb_pe_state new_state);
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+static void pe_profile_transition(int port, enum usb_pe_state new_state);
+#endif
 /*
  * The spec. revision is used to index into this array.
  *  PD 1.0 (VDO 1.0) - return VDM_VER10
@@ -824,6 +827,53 @@ int pe_is_running(int port)
 	return local_state[port] == SM_RUN;
 }
 
+__override uint64_t pe_get_next_wakeup(int port)
+{
+	static usb_state_ptr last_state[CONFIG_USB_PD_PORT_MAX_COUNT];
+	uint64_t wakeup = USBC_WAKEUP_NONE;
+	uint64_t now;
+
+	/* Paused until the Type-C layer enables PD */
+	if (local_state[port] == SM_PAUSED)
+		return tc_get_pd_enabled(port) ? USBC_WAKEUP_POLL :
+						 USBC_WAKEUP_NONE;
+
+	/* A state which was just entered has not run yet */
+	if (local_state[port] == SM_INIT ||
+	    pe[port].ctx.current != last_state[port]) {
+		last_state[port] = pe[port].ctx.current;
+		return USBC_WAKEUP_POLL;
+	}
+
+	/* Work left for the Ready states, which the protocol layer may set */
+	if (pe[port].dpm_request ||
+	    PE_CHK_FLAG(port, PE_FLAGS_MSG_RECEIVED |
+			      PE_FLAGS_VDM_REQUEST_CONTINUE))
+		return USBC_WAKEUP_POLL;
+
+	/* Everything but the Ready states is part of an ongoing AMS */
+	if (get_state_pe(port) != PE_SRC_READY &&
+	    get_state_pe(port) != PE_SNK_READY)
+		return USBC_WAKEUP_POLL;
+
+	/*
+	 * Discovery waits for discover_identity_timer, below.  Once it has
+	 * failed or finished, only a message or event moves it on.
+	 */
+	if (dpm_has_work(port))
+		return USBC_WAKEUP_POLL;
+
+	now = get_time().val;
+	usbc_wakeup_at(&wakeup, now, pe[port].timeout);
+	usbc_wakeup_at(&wakeup, now, pe[port].source_cap_timer);
+	usbc_wakeup_at(&wakeup, now, pe[port].discover_identity_timer);
+	usbc_wakeup_at(&wakeup, now, pe[port].sink_request_timer);
+	usbc_wakeup_at(&wakeup, now, pe[port].wait_and_add_jitter_timer);
+	usbc_wakeup_at(&wakeup, now, pe[port].vdm_response_timer);
+
+	return wakeup;
+}
+
 bool pe_in_local_ams(int port)
 {
 	return !!PE_CHK_FLAG(port, PE_FLAGS_LOCALLY_INITIATED_AMS);
@@ -927,7 +977,7 @@ void pe_got_hard_reset(int port)
 void pd_got_frs_signal(int port)
 {
 	PE_SET_FLAG(port, PE_FLAGS_FAST_ROLE_SWAP_SIGNALED);
-	task_set_event(PD_PORT_TO_TASK_ID(port), TASK_EVENT_WAKE, 0);
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 /*
@@ -1145,6 +1195,8 @@ void pe_got_soft_reset(int port)
 void pe_dpm_request(int port, enum pe_dpm_request req)
 {
 	PE_SET_DPM_REQUEST(port, req);
+	/* The PD task no longer polls, make sure it sees the request */
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void pe_vconn_swap_complete(int port)
@@ -1185,7 +1237,7 @@ void pd_send_vdm(int port, uint32_t vid, int cmd, const uint32_t *data,
 
 	pe[port].vdm_cnt = count + 1;
 
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 static void pe_handle_detach(void)
@@ -1214,6 +1266,9 @@ static void pe_set_dpm_curr_request(const int port,
 test_export_static void set_state_pe(const int port,
 				     const enum usb_pe_state new_state)
 {
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+	pe_profile_transition(port, new_state);
+#endif
 	set_state(port, &pe[port].ctx, &pe_states[new_state]);
 }
 
@@ -6374,6 +6429,28 @@ static const struct usb_state pe_states[] = {
 #endif /* CONFIG_USB_PD_REV30 */
 };
 
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+static struct sm_state_profile
+	pe_profile[CONFIG_USB_PD_PORT_MAX_COUNT][ARRAY_SIZE(pe_states)];
+/* When the current state was entered */
+static uint64_t pe_profile_since[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+static void pe_profile_transition(int port, enum usb_pe_state new_state)
+{
+	sm_profile_transition(pe_profile[port], &pe_profile_since[port],
+			      pe[port].ctx.current ? get_state_pe(port) : -1,
+			      new_state);
+}
+
+void pe_print_state_profile(int port)
+{
+	sm_profile_print("PE", pe_profile[port], ARRAY_SIZE(pe_states),
+			 IS_ENABLED(USB_PD_DEBUG_LABELS) ? pe_state_names : NULL,
+			 pe[port].ctx.current ? get_state_pe(port) : -1,
+			 pe_profile_since[port]);
+}
+#endif /* CONFIG_USB_PD_STATE_PROFILE */
+
 #ifdef TEST_BUILD
 const struct test_sm_data test_pe_sm_data[] = {
 	{
@@ -6389,6 +6466,8 @@ const int test_pe_sm_data_size = ARRAY_SIZE(test_pe_sm_data);
 void pe_set_flag(int port, int flag)
 {
 	PE_SET_FLAG(port, flag);
+	/* Tests stand in for another layer; make the PD task look at it */
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 void pe_clr_flag(int port, int flag)
 {
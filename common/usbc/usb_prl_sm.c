@@ -456,7 +456,7 @@ void pd_execute_hard_reset(int port)
 
 	PRL_HR_SET_FLAG(port, PRL_FLAGS_PORT_PARTNER_HARD_RESET);
 	set_state_prl_hr(port, PRL_HR_RESET_LAYER);
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void prl_execute_hard_reset(int port)
@@ -467,7 +467,7 @@ void prl_execute_hard_reset(int port)
 
 	PRL_HR_SET_FLAG(port, PRL_FLAGS_PE_HARD_RESET);
 	set_state_prl_hr(port, PRL_HR_RESET_LAYER);
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 int prl_is_running(int port)
@@ -475,6 +475,34 @@ int prl_is_running(int port)
 	return local_state[port] == SM_RUN;
 }
 
+__override uint64_t prl_get_next_wakeup(int port)
+{
+	/* Paused until the Type-C layer enables PD */
+	if (local_state[port] == SM_PAUSED)
+		return tc_get_pd_enabled(port) ? USBC_WAKEUP_POLL :
+						 USBC_WAKEUP_NONE;
+	if (local_state[port] == SM_INIT)
+		return USBC_WAKEUP_POLL;
+
+	/*
+	 * All protocol timers belong to transmissions, hard resets or chunked
+	 * transfers in progress, which are polled.  When idle, only received
+	 * messages (TCPC events) and requests from the PE move it.
+	 */
+	if (prl_tx_get_state(port) != PRL_TX_WAIT_FOR_MESSAGE_REQUEST ||
+	    prl_hr_get_state(port) != PRL_HR_WAIT_FOR_REQUEST ||
+	    prl_is_busy(port))
+		return USBC_WAKEUP_POLL;
+
+	/* Only one received message is taken per run */
+	if (tcpm_has_pending_message(port) ||
+	    (IS_ENABLED(CONFIG_USB_PD_EXTENDED_MESSAGES) &&
+	     RCH_CHK_FLAG(port, PRL_FLAGS_MSG_RECEIVED)))
+		return USBC_WAKEUP_POLL;
+
+	return USBC_WAKEUP_NONE;
+}
+
 static void prl_init(int port)
 {
 	int i;
@@ -542,7 +570,7 @@ void prl_set_debug_level(enum debug_level debug_level)
 void prl_hard_reset_complete(int port)
 {
 	PRL_HR_SET_FLAG(port, PRL_FLAGS_HARD_RESET_COMPLETE);
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void prl_send_ctrl_msg(int port,
@@ -562,7 +590,7 @@ void prl_send_ctrl_msg(int port,
 	PRL_TX_SET_FLAG(port, PRL_FLAGS_MSG_XMIT);
 #endif /* CONFIG_USB_PD_REV30 */
 
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void prl_send_data_msg(int port,
@@ -581,7 +609,7 @@ void prl_send_data_msg(int port,
 	PRL_TX_SET_FLAG(port, PRL_FLAGS_MSG_XMIT);
 #endif /* CONFIG_USB_PD_REV30 */
 
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 #ifdef CONFIG_USB_PD_EXTENDED_MESSAGES
@@ -594,7 +622,7 @@ void prl_send_ext_data_msg(int port,
 	pdmsg[port].ext = 1;
 
 	TCH_SET_FLAG(port, PRL_FLAGS_MSG_XMIT);
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 #endif /* CONFIG_USB_PD_EXTENDED_MESSAGES */
 
@@ -617,7 +645,7 @@ void prl_reset_soft(int port)
 	local_state[port] = SM_INIT;
 
 	/* Ensure we process the reset quickly */
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void prl_reset(int port)
@@ -626,7 +654,7 @@ void prl_reset(int port)
 	local_state[port] = SM_INIT;
 
 	/* Ensure we process the reset quickly */
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void prl_run(int port, int evt, int en)
@@ -1040,7 +1068,7 @@ static void prl_tx_wait_for_phy_response_run(const int port)
 		 * This event reduces the time of informing the policy engine of
 		 * the transmission by one state machine cycle
 		 */
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 		set_state_prl_tx(port, PRL_TX_WAIT_FOR_MESSAGE_REQUEST);
 	} else if ((!IS_ENABLED(BOARD_DELBIN) && timed_out) ||
 		   prl_tx[port].xmit_status == TCPC_TX_COMPLETE_FAILED ||
@@ -1497,7 +1525,7 @@ static void rch_requesting_chunk_entry(const int port)
 	pdmsg[port].data_objs = 1;
 	pdmsg[port].ext = 1;
 	PRL_TX_SET_FLAG(port, PRL_FLAGS_MSG_XMIT);
-	task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_TX, 0);
+	pd_task_set_event(port, PD_EVENT_TX);
 }
 
 static void rch_requesting_chunk_run(const int port)
@@ -2111,7 +2139,7 @@ static void prl_rx_wait_for_phy_message(const int port, int evt)
 		pe_message_received(port);
 	}
 
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 /* All necessary Protocol Transmit States (Section 6.11.2.2) */
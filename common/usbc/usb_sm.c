@@ -7,6 +7,7 @@
 #include "console.h"
 #include "stdbool.h"
 #include "task.h"
+#include "timer.h"
 #include "usb_pd.h"
 #include "usb_sm.h"
 #include "util.h"
@@ -29,34 +30,40 @@ struct internal_ctx {
 BUILD_ASSERT(sizeof(struct internal_ctx) ==
 	     member_size(struct sm_ctx, internal));
 
+/* Gets the number of states from s up to its root state (inclusive) */
+static int state_depth(usb_state_ptr s)
+{
+	int depth = 0;
+
+	/* This assumes that the parent chain is NULL terminated without cycles */
+	for (; s != NULL; s = s->parent)
+		depth++;
+
+	return depth;
+}
+
 /* Gets the first shared parent state between a and b (inclusive) */
 static usb_state_ptr shared_parent_state(usb_state_ptr a, usb_state_ptr b)
 {
-	const usb_state_ptr orig_b = b;
-
-	/* There are no common ancestors */
-	if (b == NULL)
-		return NULL;
-
-	/* This assumes that both A and B are NULL terminated without cycles */
-	while (a != NULL) {
-		/* We found a match return */
-		if (a == b)
-			return a;
-
-		/*
-		 * Otherwise, increment b down the list for comparison until we
-		 * run out, then increment a and start over on b for comparison
-		 */
-		if (b->parent == NULL) {
-			a = a->parent;
-			b = orig_b;
-		} else {
-			b = b->parent;
-		}
+	int depth_a = state_depth(a);
+	int depth_b = state_depth(b);
+
+	/*
+	 * Bring the deeper state up to the level of the other one, then walk
+	 * both chains up in step until they meet, which they do at the latest
+	 * past their roots (NULL, no common ancestor).
+	 */
+	for (; depth_a > depth_b; depth_a--)
+		a = a->parent;
+	for (; depth_b > depth_a; depth_b--)
+		b = b->parent;
+
+	while (a != b) {
+		a = a->parent;
+		b = b->parent;
 	}
 
-	return NULL;
+	return a;
 }
 
 /*
@@ -167,7 +174,7 @@ void set_state(const int port, struct sm_ctx *const ctx,
 	 * delay important processing until the next task interval.
 	 */
 	if (IS_ENABLED(HAS_TASK_PD_C0))
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 /*
@@ -200,3 +207,44 @@ void run_state(const int port, struct sm_ctx *const ctx)
 	call_run_functions(port, internal, ctx->current);
 	internal->running = false;
 }
+
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+void sm_profile_transition(struct sm_state_profile *profile, uint64_t *since,
+			   int from, int to)
+{
+	const uint64_t now = get_time().val;
+
+	if (from >= 0)
+		profile[from].time_us += now - *since;
+	profile[to].entries++;
+	*since = now;
+}
+
+void sm_profile_print(const char *sm, const struct sm_state_profile *profile,
+		      int count, const char * const *names, int current,
+		      uint64_t since)
+{
+	int i;
+
+	ccprintf("%s profile:\n", sm);
+	for (i = 0; i < count; i++) {
+		uint64_t time_us = profile[i].time_us;
+
+		if (!profile[i].entries)
+			continue;
+
+		/* Include the time spent so far in the current state */
+		if (i == current)
+			time_us += get_time().val - since;
+		uint64divmod(&time_us, MSEC);
+
+		if (names)
+			ccprintf("  %-32s", names[i]);
+		else
+			ccprintf("  st%-30d", i);
+		ccprintf(" %8u entries %10u ms\n", profile[i].entries,
+			 (uint32_t)time_us);
+		cflush();
+	}
+}
+#endif /* CONFIG_USB_PD_STATE_PROFILE */
@@ -117,6 +117,8 @@
 #define TC_FLAGS_CHECK_CONNECTION       BIT(20)
 /* Flag to note pd_set_suspend SUSPEND state */
 #define TC_FLAGS_SUSPEND                BIT(21)
+/* Flag to note TCPC was still booting when the state machine restarted */
+#define TC_FLAGS_TCPC_INIT_RETRY        BIT(22)
 
 /*
  * Clear all flags except TC_FLAGS_LPM_ENGAGED and TC_FLAGS_SUSPEND.
@@ -127,6 +129,9 @@
 /* 100 ms is enough time for any TCPC transaction to complete. */
 #define PD_LPM_DEBOUNCE_US (100 * MSEC)
 
+/* Time between TCPC init attempts while the TCPC reports it is busy */
+#define TCPC_INIT_RETRY_US (10 * MSEC)
+
 /*
  * This delay is not part of the USB Type-C specification or the USB port
  * controller specification. Some TCPCs require extra time before the CC_STATUS
@@ -306,6 +311,7 @@ static struct bit_name flag_bit_names[] = {
 	{ TC_FLAGS_DISC_IDENT_IN_PROGRESS, "DISC_IDENT_IN_PROGRESS" },
 	{ TC_FLAGS_CHECK_CONNECTION, "CHECK_CONNECTION" },
 	{ TC_FLAGS_SUSPEND, "SUSPEND" },
+	{ TC_FLAGS_TCPC_INIT_RETRY, "TCPC_INIT_RETRY" },
 };
 
 static struct bit_name event_bit_names[] = {
@@ -416,6 +422,10 @@ static struct type_c {
 	uint64_t low_power_time;
 	/* Time to debounce exit low power mode */
 	uint64_t low_power_exit_time;
+	/* Time to retry a TCPC reset which found the TCPC busy */
+	uint64_t tcpc_reset_retry;
+	/* State to restart in once a busy TCPC has been initialized */
+	enum usb_tc_state init_retry_state;
 	/* Tasks to notify after TCPC has been reset */
 	int tasks_waiting_on_reset;
 	/* Tasks preventing TCPC from entering low power mode */
@@ -454,6 +464,9 @@ static void pd_update_dual_role_config(int port);
 
 /* Forward declare common, private functions */
 static void set_state_tc(const int port, const enum usb_tc_state new_state);
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+static void tc_profile_transition(int port, enum usb_tc_state new_state);
+#endif
 test_export_static enum usb_tc_state get_state_tc(const int port);
 
 #ifdef CONFIG_USB_PD_TRY_SRC
@@ -526,7 +539,7 @@ void pd_request_source_voltage(int port, int mv)
 		else
 			pe_dpm_request(port, DPM_REQUEST_PR_SWAP);
 
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -539,7 +552,7 @@ void pd_set_external_voltage_limit(int port, int mv)
 		if (get_state_tc(port) == TC_ATTACHED_SNK)
 			pe_dpm_request(port, DPM_REQUEST_NEW_POWER_LEVEL);
 
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -608,6 +621,7 @@ static void tc_policy_pd_enable(int port, int en)
 		atomic_or(&tc[port].pd_disabled_mask, PD_DISABLED_BY_POLICY);
 
 	CPRINTS("C%d: PD comm policy %sabled", port, en ? "en" : "dis");
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 static void tc_enable_pd(int port, int en)
@@ -646,7 +660,7 @@ static inline void pd_set_dual_role_and_event(int port,
 		pd_update_try_source();
 
 	if (event != 0)
-		task_set_event(PD_PORT_TO_TASK_ID(port), event, 0);
+		pd_task_set_event(port, event);
 }
 
 void pd_set_dual_role(int port, enum pd_dual_role_states state)
@@ -674,7 +688,7 @@ void pd_request_data_swap(int port)
 	 */
 	if (IS_ATTACHED_SRC(port) || IS_ATTACHED_SNK(port)) {
 		TC_SET_FLAG(port, TC_FLAGS_REQUEST_DR_SWAP);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -868,7 +882,7 @@ void tc_prs_src_snk_assert_rd(int port)
 		 * DebugAccessory.SNK assert Rd
 		 */
 		TC_SET_FLAG(port, TC_FLAGS_REQUEST_PR_SWAP);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -884,7 +898,7 @@ void tc_prs_snk_src_assert_rp(int port)
 		 * UnorientedDebugAccessory.SRC to assert Rp
 		 */
 		TC_SET_FLAG(port, TC_FLAGS_REQUEST_PR_SWAP);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -905,7 +919,7 @@ void tc_prs_snk_src_assert_rp(int port)
 void tc_hard_reset_request(int port)
 {
 	TC_SET_FLAG(port, TC_FLAGS_HARD_RESET_REQUESTED);
-	task_wake(PD_PORT_TO_TASK_ID(port));
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 }
 
 void tc_disc_ident_in_progress(int port)
@@ -992,7 +1006,7 @@ void pd_set_suspend(int port, int suspend)
 		if (PD_PORT_TO_TASK_ID(port) == task_get_current())
 			return;
 
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 
 		/* Sleep this task if we are not suspended */
 		while (pd_is_port_enabled(port)) {
@@ -1005,7 +1019,7 @@ void pd_set_suspend(int port, int suspend)
 		}
 	} else {
 		TC_CLR_FLAG(port, TC_FLAGS_SUSPEND);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -1295,6 +1309,19 @@ static void restart_tc_sm(int port, enum usb_tc_state start_state)
 
 	res = tcpm_init(port);
 
+	/*
+	 * A TCPC which is still booting under the shared PD task reports
+	 * busy rather than blocking every port. Hold the CC lines open in
+	 * ErrorRecovery and try again shortly.
+	 */
+	if (res == EC_ERROR_BUSY) {
+		TC_SET_FLAG(port, TC_FLAGS_TCPC_INIT_RETRY);
+		tc[port].init_retry_state = start_state;
+		set_state_tc(port, TC_ERROR_RECOVERY);
+		tc[port].timeout = get_time().val + TCPC_INIT_RETRY_US;
+		return;
+	}
+
 	CPRINTS("C%d: TCPC init %s", port, res ? "failed" : "ready");
 
 	/*
@@ -1419,6 +1446,65 @@ uint8_t tc_get_pd_enabled(int port)
 	return !tc[port].pd_disabled_mask;
 }
 
+/* Requests which the current state acts on at its next run */
+#define TC_FLAGS_PENDING_WORK (TC_FLAGS_REQUEST_VC_SWAP_ON | \
+			       TC_FLAGS_REQUEST_VC_SWAP_OFF | \
+			       TC_FLAGS_REQUEST_PR_SWAP | \
+			       TC_FLAGS_REQUEST_DR_SWAP | \
+			       TC_FLAGS_POWER_OFF_SNK | \
+			       TC_FLAGS_HARD_RESET_REQUESTED | \
+			       TC_FLAGS_PR_SWAP_IN_PROGRESS | \
+			       TC_FLAGS_CHECK_CONNECTION)
+
+/*
+ * Only the settled states are driven purely by CC/VBUS events and timers; the
+ * others poll the TCPC while they debounce.
+ */
+static bool tc_state_is_settled(enum usb_tc_state state)
+{
+	return state == TC_DISABLED ||
+	       state == TC_UNATTACHED_SNK ||
+	       state == TC_ATTACHED_SNK ||
+	       state == TC_UNATTACHED_SRC ||
+	       state == TC_ATTACHED_SRC ||
+	       (IS_ENABLED(CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE) &&
+		state == TC_DRP_AUTO_TOGGLE) ||
+	       (IS_ENABLED(CONFIG_USB_PD_TCPC_LOW_POWER) &&
+		state == TC_LOW_POWER_MODE);
+}
+
+__override uint64_t tc_get_next_wakeup(int port)
+{
+	static usb_state_ptr last_state[CONFIG_USB_PD_PORT_MAX_COUNT];
+	uint64_t wakeup = USBC_WAKEUP_NONE;
+	uint64_t now;
+
+	/* A state which was just entered has not run yet */
+	if (tc[port].ctx.current != last_state[port]) {
+		last_state[port] = tc[port].ctx.current;
+		return USBC_WAKEUP_POLL;
+	}
+
+	if (tc[port].flags & TC_FLAGS_PENDING_WORK)
+		return USBC_WAKEUP_POLL;
+
+	if (!tc_state_is_settled(get_state_tc(port)))
+		return USBC_WAKEUP_POLL;
+
+	now = get_time().val;
+	usbc_wakeup_at(&wakeup, now, tc[port].drp_sink_time);
+	usbc_wakeup_at(&wakeup, now, tc[port].cc_debounce);
+	usbc_wakeup_at(&wakeup, now, tc[port].pd_debounce);
+	usbc_wakeup_at(&wakeup, now, tc[port].vbus_debounce_time);
+	usbc_wakeup_at(&wakeup, now, tc[port].next_role_swap);
+	usbc_wakeup_at(&wakeup, now, tc[port].timeout);
+	usbc_wakeup_at(&wakeup, now, tc[port].low_power_time);
+	usbc_wakeup_at(&wakeup, now, tc[port].low_power_exit_time);
+	usbc_wakeup_at(&wakeup, now, tc[port].tcpc_reset_retry);
+
+	return wakeup;
+}
+
 bool pd_alt_mode_capable(int port)
 {
 	return IS_ENABLED(CONFIG_USB_PE_SM) && tc_get_pd_enabled(port);
@@ -1438,6 +1524,9 @@ static void set_state_tc(const int port, const enum usb_tc_state new_state)
 {
 	assert(port == TASK_ID_TO_PD_PORT(task_get_current()));
 
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+	tc_profile_transition(port, new_state);
+#endif
 	set_state(port, &tc[port].ctx, &tc_states[new_state]);
 }
 
@@ -1480,7 +1569,9 @@ void tc_event_check(int port, int evt)
 	if (evt & PD_EVENT_DEVICE_ACCESSED)
 		handle_device_access(port);
 
-	if (evt & PD_EVENT_TCPC_RESET)
+	if ((evt & PD_EVENT_TCPC_RESET) ||
+	    (tc[port].tcpc_reset_retry &&
+	     get_time().val >= tc[port].tcpc_reset_retry))
 		reset_device_and_notify(port);
 
 	if (evt & PD_EVENT_RX_HARD_RESET)
@@ -1678,7 +1769,7 @@ void pd_request_vconn_swap_off(int port)
 	if (get_state_tc(port) == TC_ATTACHED_SRC ||
 			get_state_tc(port) == TC_ATTACHED_SNK) {
 		TC_SET_FLAG(port, TC_FLAGS_REQUEST_VC_SWAP_OFF);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -1687,7 +1778,7 @@ void pd_request_vconn_swap_on(int port)
 	if (get_state_tc(port) == TC_ATTACHED_SRC ||
 			get_state_tc(port) == TC_ATTACHED_SNK) {
 		TC_SET_FLAG(port, TC_FLAGS_REQUEST_VC_SWAP_ON);
-		task_wake(PD_PORT_TO_TASK_ID(port));
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -1716,6 +1807,17 @@ static __maybe_unused int reset_device_and_notify(int port)
 	TC_SET_FLAG(port, TC_FLAGS_LPM_TRANSITION);
 	rv = tcpm_init(port);
 	TC_CLR_FLAG(port, TC_FLAGS_LPM_TRANSITION);
+
+	/*
+	 * The TCPC is still waking up. Leave it marked as in low power mode,
+	 * with the waiting tasks blocked, and try again from the PD task.
+	 */
+	if (rv == EC_ERROR_BUSY) {
+		tc[port].tcpc_reset_retry = get_time().val + TCPC_INIT_RETRY_US;
+		return rv;
+	}
+	tc[port].tcpc_reset_retry = 0;
+
 	TC_CLR_FLAG(port, TC_FLAGS_LPM_ENGAGED);
 	tc_start_event_loop(port);
 
@@ -1756,7 +1858,11 @@ void pd_wait_exit_low_power(int port)
 	if (!TC_CHK_FLAG(port, TC_FLAGS_LPM_ENGAGED))
 		return;
 
-	if (port == TASK_ID_TO_PD_PORT(task_get_current())) {
+	/*
+	 * The shared PD task owns every port, so it must not wait on itself
+	 * when servicing one port touches the TCPC of another.
+	 */
+	if (PD_PORT_TO_TASK_ID(port) == task_get_current()) {
 		if (!TC_CHK_FLAG(port, TC_FLAGS_LPM_TRANSITION))
 			reset_device_and_notify(port);
 	} else {
@@ -1771,8 +1877,7 @@ void pd_wait_exit_low_power(int port)
 		 * happen much, but it if starts occurring, we can add a guard
 		 * to prevent/reduce it.
 		 */
-		task_set_event(PD_PORT_TO_TASK_ID(port),
-			       PD_EVENT_TCPC_RESET, 0);
+		pd_task_set_event(port, PD_EVENT_TCPC_RESET);
 		task_wait_event_mask(TASK_EVENT_PD_AWAKE, -1);
 	}
 }
@@ -1783,11 +1888,10 @@ void pd_wait_exit_low_power(int port)
  */
 void pd_device_accessed(int port)
 {
-	if (port == TASK_ID_TO_PD_PORT(task_get_current()))
+	if (PD_PORT_TO_TASK_ID(port) == task_get_current())
 		handle_device_access(port);
 	else
-		task_set_event(PD_PORT_TO_TASK_ID(port),
-			PD_EVENT_DEVICE_ACCESSED, 0);
+		pd_task_set_event(port, PD_EVENT_DEVICE_ACCESSED);
 }
 
 /*
@@ -1877,7 +1981,9 @@ static void tc_disabled_run(const int port)
 	if (!TC_CHK_FLAG(port, TC_FLAGS_SUSPEND))
 		set_state_tc(port, TC_UNATTACHED_SNK);
 
-	task_wait_event(-1);
+	/* The shared PD task has other ports to service */
+	if (!IS_ENABLED(CONFIG_USB_PD_SHARED_TASK))
+		task_wait_event(-1);
 }
 
 static void tc_disabled_exit(const int port)
@@ -1911,6 +2017,12 @@ static void tc_error_recovery_run(const int port)
 	if (get_time().val < tc[port].timeout)
 		return;
 
+	/* The TCPC was busy when we restarted, so try it again */
+	if (TC_CHK_FLAG(port, TC_FLAGS_TCPC_INIT_RETRY)) {
+		restart_tc_sm(port, tc[port].init_retry_state);
+		return;
+	}
+
 	/*
 	 * If we transitioned to error recovery as the first state and we
 	 * didn't brown out, we don't need to reinitialized the tc statemachine
@@ -3615,6 +3727,28 @@ static const struct usb_state tc_states[] = {
 #endif
 };
 
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+static struct sm_state_profile
+	tc_profile[CONFIG_USB_PD_PORT_MAX_COUNT][ARRAY_SIZE(tc_states)];
+/* When the current state was entered */
+static uint64_t tc_profile_since[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+static void tc_profile_transition(int port, enum usb_tc_state new_state)
+{
+	sm_profile_transition(tc_profile[port], &tc_profile_since[port],
+			      tc[port].ctx.current ? get_state_tc(port) : -1,
+			      new_state);
+}
+
+void tc_print_state_profile(int port)
+{
+	sm_profile_print("TC", tc_profile[port], ARRAY_SIZE(tc_states),
+			 IS_ENABLED(USB_PD_DEBUG_LABELS) ? tc_state_names : NULL,
+			 tc[port].ctx.current ? get_state_tc(port) : -1,
+			 tc_profile_since[port]);
+}
+#endif /* CONFIG_USB_PD_STATE_PROFILE */
+
 #if defined(TEST_BUILD) && defined(USB_PD_DEBUG_LABELS)
 const struct test_sm_data test_tc_sm_data[] = {
 	{
@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "atomic.h"
 #include "battery.h"
 #include "battery_smart.h"
 #include "board.h"
@@ -32,13 +33,28 @@
 #include "usbc_ppc.h"
 #include "version.h"
 
+/* Poll interval while a state machine is busy */
 #define USBC_EVENT_TIMEOUT (5 * MSEC)
+/*
+ * Longest sleep while the state machines are settled, as a backstop for any
+ * input which changes without raising an event, such as the chipset state
+ * polled by the TC states. Kept short enough that those changes are still
+ * acted on within the Type-C timing budgets.
+ */
+#define USBC_IDLE_TIMEOUT (40 * MSEC)
 
 #define CPRINTF(format, args...) cprintf(CC_USBPD, format, ## args)
 #define CPRINTS(format, args...) cprints(CC_USBPD, format, ## args)
 
 static uint8_t paused[CONFIG_USB_PD_PORT_MAX_COUNT];
 
+#ifdef CONFIG_CMD_PD_STATS
+/* PD task wakeups, and how many were on timeout, since the last pdstats */
+test_export_static uint32_t pd_wakeups[CONFIG_USB_PD_PORT_MAX_COUNT];
+test_export_static uint32_t pd_timer_wakeups[CONFIG_USB_PD_PORT_MAX_COUNT];
+static timestamp_t pd_stats_since;
+#endif
+
 void tc_pause_event_loop(int port)
 {
 	paused[port] = 1;
@@ -52,7 +68,7 @@ void tc_start_event_loop(int port)
 	 */
 	if (paused[port]) {
 		paused[port] = 0;
-		task_set_event(PD_PORT_TO_TASK_ID(port), TASK_EVENT_WAKE, 0);
+		pd_task_set_event(port, TASK_EVENT_WAKE);
 	}
 }
 
@@ -73,20 +89,64 @@ static void pd_task_init(int port)
 		schedule_deferred_pd_interrupt(port);
 }
 
-static bool pd_task_loop(int port)
+/*
+ * Default for state machines which don't track their deadlines, they are run
+ * at the regular poll interval.
+ */
+__overridable uint64_t tc_get_next_wakeup(int port)
 {
-	/* wait for next event/packet or timeout expiration */
-	const uint32_t evt =
-		task_wait_event(paused[port]
-					? -1
-					: USBC_EVENT_TIMEOUT);
+	return USBC_WAKEUP_POLL;
+}
 
-	/*
-	 * Re-use TASK_EVENT_RESET_DONE in tests to restart the USB task
-	 * if this code is running in a unit test.
-	 */
-	if (IS_ENABLED(TEST_BUILD) && (evt & TASK_EVENT_RESET_DONE))
-		return false;
+__overridable uint64_t pe_get_next_wakeup(int port)
+{
+	return USBC_WAKEUP_POLL;
+}
+
+__overridable uint64_t prl_get_next_wakeup(int port)
+{
+	return USBC_WAKEUP_POLL;
+}
+
+/*
+ * Return how long the PD task may sleep: until the earliest deadline of the
+ * state machines, or for the regular poll interval if any of them is busy.
+ */
+static int pd_task_timeout(int port)
+{
+	uint64_t wakeup = USBC_WAKEUP_NONE;
+	uint64_t now;
+
+	if (paused[port])
+		return -1;
+
+	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
+		wakeup = MIN(wakeup, tc_get_next_wakeup(port));
+	if (IS_ENABLED(CONFIG_USB_PE_SM))
+		wakeup = MIN(wakeup, pe_get_next_wakeup(port));
+	if (IS_ENABLED(CONFIG_USB_PRL_SM))
+		wakeup = MIN(wakeup, prl_get_next_wakeup(port));
+
+	if (wakeup == USBC_WAKEUP_POLL)
+		return USBC_EVENT_TIMEOUT;
+
+	/* Timers expire once the time is past their deadline */
+	now = get_time().val;
+	if (wakeup < now)
+		return 1;
+	if (wakeup - now >= USBC_IDLE_TIMEOUT)
+		return USBC_IDLE_TIMEOUT;
+	return wakeup - now + 1;
+}
+
+/* Run the state machines of a port for the events it received */
+static void pd_port_run(int port, uint32_t evt)
+{
+#ifdef CONFIG_CMD_PD_STATS
+	pd_wakeups[port]++;
+	if (evt & TASK_EVENT_TIMER)
+		pd_timer_wakeups[port]++;
+#endif
 
 	/* handle events that affect the state machine as a whole */
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
@@ -110,6 +170,22 @@ static bool pd_task_loop(int port)
 	/* Run TypeC state machine */
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_run(port);
+}
+
+#ifndef CONFIG_USB_PD_SHARED_TASK
+static bool pd_task_loop(int port)
+{
+	/* wait for next event/packet or timeout expiration */
+	const uint32_t evt = task_wait_event(pd_task_timeout(port));
+
+	/*
+	 * Re-use TASK_EVENT_RESET_DONE in tests to restart the USB task
+	 * if this code is running in a unit test.
+	 */
+	if (IS_ENABLED(TEST_BUILD) && (evt & TASK_EVENT_RESET_DONE))
+		return false;
+
+	pd_port_run(port, evt);
 
 	return true;
 }
@@ -137,3 +213,124 @@ void pd_task(void *u)
 			continue;
 	}
 }
+#else /* CONFIG_USB_PD_SHARED_TASK */
+/* Events for each port, collected until the shared task services it */
+static uint32_t pd_port_events[CONFIG_USB_PD_PORT_MAX_COUNT];
+/* When each port next needs to run without an event, in usec */
+static uint64_t pd_port_next_run[CONFIG_USB_PD_PORT_MAX_COUNT];
+/* Port the shared task is servicing */
+static int pd_current_port;
+
+void pd_task_set_event(int port, uint32_t event)
+{
+	atomic_or(&pd_port_events[port], event);
+	task_set_event(TASK_ID_PD_C0, PD_EVENT_PORT_PENDING, 0);
+}
+
+int pd_task_get_port(void)
+{
+	return pd_current_port;
+}
+
+static void pd_port_schedule(int port)
+{
+	const int timeout = pd_task_timeout(port);
+
+	if (timeout < 0)
+		pd_port_next_run[port] = USBC_WAKEUP_NONE;
+	else
+		pd_port_next_run[port] = get_time().val + timeout;
+}
+
+static bool pd_task_loop(int port_count)
+{
+	uint64_t next_run = USBC_WAKEUP_NONE;
+	uint64_t now = get_time().val;
+	int timeout = -1;
+	uint32_t evt;
+	int port;
+
+	for (port = 0; port < port_count; port++)
+		next_run = MIN(next_run, pd_port_next_run[port]);
+	if (next_run != USBC_WAKEUP_NONE)
+		timeout = next_run > now ? MIN(next_run - now, INT32_MAX) : 1;
+
+	/* wait for the next event or the earliest port deadline */
+	evt = task_wait_event(timeout);
+
+	/*
+	 * Re-use TASK_EVENT_RESET_DONE in tests to restart the USB task
+	 * if this code is running in a unit test.
+	 */
+	if (IS_ENABLED(TEST_BUILD) && (evt & TASK_EVENT_RESET_DONE))
+		return false;
+
+	/* Events set on the task itself are not tied to one port */
+	evt &= ~(PD_EVENT_PORT_PENDING | TASK_EVENT_TIMER);
+
+	now = get_time().val;
+	for (port = 0; port < port_count; port++) {
+		uint32_t port_evt = atomic_read_clear(&pd_port_events[port]) |
+				    evt;
+
+		if (now >= pd_port_next_run[port])
+			port_evt |= TASK_EVENT_TIMER;
+		if (!port_evt)
+			continue;
+
+		pd_current_port = port;
+		pd_port_run(port, port_evt);
+		pd_port_schedule(port);
+	}
+
+	return true;
+}
+
+/* A single task running the state machines of every port */
+void pd_task(void *u)
+{
+	const int port_count = board_get_usb_pd_port_count();
+	int port;
+
+	while (1) {
+		for (port = 0; port < port_count; port++) {
+			pd_current_port = port;
+			pd_task_init(port);
+			/* Run each port once to get its state machines going */
+			pd_port_next_run[port] = 0;
+		}
+
+		while (pd_task_loop(port_count))
+			continue;
+	}
+}
+#endif /* CONFIG_USB_PD_SHARED_TASK */
+
+#ifdef CONFIG_CMD_PD_STATS
+static int command_pd_stats(int argc, char **argv)
+{
+	uint64_t elapsed_ms = get_time().val - pd_stats_since.val;
+	int port;
+
+	uint64divmod(&elapsed_ms, MSEC);
+	elapsed_ms = MAX(elapsed_ms, 1);
+
+	ccprintf("Port  Wakeups  On timer  Per sec\n");
+	for (port = 0; port < board_get_usb_pd_port_count(); port++) {
+		uint64_t per_sec = (uint64_t)pd_wakeups[port] * MSEC;
+
+		uint64divmod(&per_sec, (int)MIN(elapsed_ms, INT32_MAX));
+		ccprintf("C%d    %7u  %8u  %7u\n", port,
+			 pd_wakeups[port], pd_timer_wakeups[port],
+			 (uint32_t)per_sec);
+	}
+
+	/* Start a new measurement window */
+	memset(pd_wakeups, 0, sizeof(pd_wakeups));
+	memset(pd_timer_wakeups, 0, sizeof(pd_timer_wakeups));
+	pd_stats_since = get_time();
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(pdstats, command_pd_stats, NULL,
+			     "Print and reset PD task wakeup counts");
+#endif /* CONFIG_CMD_PD_STATS */
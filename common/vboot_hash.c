@@ -18,6 +18,7 @@
 #include "task.h"
 #include "timer.h"
 #include "util.h"
+#include "vboot_hash.h"
 #include "watchdog.h"
 
 /* Console output macros */
@@ -33,6 +34,9 @@ struct vboot_hash_tag {
 #define VBOOT_HASH_SYSJUMP_TAG 0x5648 /* "VH" */
 #define VBOOT_HASH_SYSJUMP_VERSION 1
 
+#define VBOOT_HASH_CACHE_SYSJUMP_TAG 0x5643 /* "VC" */
+#define VBOOT_HASH_CACHE_SYSJUMP_VERSION 1
+
 #define CHUNK_SIZE 1024       /* Bytes to hash per deferred call */
 #define WORK_INTERVAL_US 100  /* Delay between deferred calls */
 
@@ -41,15 +45,160 @@ SHARED_MEM_CHECK_SIZE(CHUNK_SIZE);
 
 static uint32_t data_offset;
 static uint32_t data_size;
-static uint32_t curr_pos;
+test_export_static uint32_t curr_pos;
 static const uint8_t *hash;   /* Hash, or NULL if not valid */
 static int want_abort;
 static int in_progress;
 #define VBOOT_HASH_DEFERRED	true
 #define VBOOT_HASH_BLOCKING	false
 
+/* Start time of the current hash, and time taken by the last one */
+static timestamp_t hash_start_time;
+static uint32_t hash_time_us;
+/* Data position the last hash started from, if it resumed from the cache */
+test_export_static uint32_t resume_pos;
+/* Bytes hashed per chunk, bigger when read through shared memory */
+static int chunk_size = CHUNK_SIZE;
+
 static struct sha256_ctx ctx;
 
+#ifdef CONFIG_VBOOT_HASH_CACHE
+/*
+ * SHA256 state at the start of each of CONFIG_VBOOT_HASH_CACHE equal regions
+ * of the last data hashed without a nonce.  Hashing the same data again only
+ * has to restart from the first region written to flash since then; the
+ * digest is still the plain SHA256 of all the data.  The state at the start
+ * of region 0 is the initial state, so it isn't stored.
+ */
+struct vboot_hash_cache {
+	uint32_t offset;
+	uint32_t size;
+	/* Regions with a known start state, 0 if the cache is empty */
+	uint32_t valid;
+	uint32_t state[CONFIG_VBOOT_HASH_CACHE - 1][8];
+};
+static struct vboot_hash_cache cache;
+/* True if the hash in progress saves its state in the cache */
+static bool cache_active;
+
+BUILD_ASSERT(CONFIG_VBOOT_HASH_CACHE >= 2);
+
+static uint32_t cache_region_size(void)
+{
+	/* Regions end on SHA256 block boundaries, where no data is buffered */
+	return DIV_ROUND_UP(cache.size,
+			    CONFIG_VBOOT_HASH_CACHE * SHA256_BLOCK_SIZE) *
+		SHA256_BLOCK_SIZE;
+}
+
+/**
+ * Set up the cache for a new hash, and resume from the cache if possible.
+ */
+static void cache_start(uint32_t offset, uint32_t size, int nonce_size)
+{
+	uint32_t region;
+	int i;
+
+	/* A nonce changes every state after it, so don't use the cache */
+	cache_active = !nonce_size && size;
+	if (!cache_active)
+		return;
+
+	if (cache.offset != offset || cache.size != size) {
+		cache.offset = offset;
+		cache.size = size;
+		cache.valid = 0;
+	}
+	if (!cache.valid)
+		cache.valid = 1;
+
+	i = cache.valid - 1;
+	if (!i)
+		return;
+
+	region = cache_region_size();
+	memcpy(ctx.h, cache.state[i - 1], sizeof(ctx.h));
+	ctx.tot_len = i * region;
+	curr_pos = i * region;
+}
+
+/**
+ * Save the hash state if the hash has just reached the start of a region.
+ */
+static void cache_save(void)
+{
+	uint32_t region;
+	int i;
+
+	if (!cache_active || curr_pos >= data_size)
+		return;
+
+	region = cache_region_size();
+	if (curr_pos % region)
+		return;
+
+	i = curr_pos / region;
+
+	/* Don't let a flash write slip in between the checks and the save */
+	interrupt_disable();
+	if (cache_active && i == cache.valid && i < CONFIG_VBOOT_HASH_CACHE) {
+		memcpy(cache.state[i - 1], ctx.h, sizeof(ctx.h));
+		cache.valid++;
+	}
+	interrupt_enable();
+}
+
+void vboot_hash_cache_invalidate(int offset, int size)
+{
+	uint32_t start = offset;
+
+	if (!cache.valid || offset < 0 || size <= 0 ||
+	    start + size <= cache.offset || start >= cache.offset + cache.size)
+		return;
+
+	/*
+	 * A hash in progress may already have read data from before the
+	 * write, so it mustn't save any more states.
+	 */
+	cache_active = false;
+
+	/* The state at the start of the first region written is still good */
+	if (start <= cache.offset)
+		cache.valid = 1;
+	else
+		cache.valid = MIN(cache.valid,
+				  (start - cache.offset) /
+				  cache_region_size() + 1);
+}
+#else
+static inline void cache_start(uint32_t offset, uint32_t size,
+			       int nonce_size)
+{
+}
+
+static inline void cache_save(void)
+{
+}
+#endif
+
+/**
+ * Returns the number of bytes to hash next, starting at data position <pos>.
+ */
+static int next_chunk_size(uint32_t pos)
+{
+	int size = MIN(chunk_size, data_size - pos);
+
+#ifdef CONFIG_VBOOT_HASH_CACHE
+	/* Stop at the end of each region, to save the state there */
+	if (cache_active) {
+		uint32_t region = cache_region_size();
+
+		size = MIN(size, region - pos % region);
+	}
+#endif
+	return size;
+}
+
 int vboot_hash_in_progress(void)
 {
 	return in_progress;
@@ -73,32 +222,55 @@ void vboot_hash_abort(void)
 static void vboot_hash_next_chunk(void);
 DECLARE_DEFERRED(vboot_hash_next_chunk);
 
-#ifndef CONFIG_MAPPED_STORAGE
+#if defined(CONFIG_MAPPED_STORAGE)
 
-static int read_and_hash_chunk(int offset, int size)
+static int hash_next_chunk(void)
 {
+	int size = next_chunk_size(curr_pos);
+
+	flash_lock_mapped_storage(1);
+	SHA256_update(&ctx, (const uint8_t *)(CONFIG_MAPPED_STORAGE_BASE +
+					      data_offset + curr_pos), size);
+	flash_lock_mapped_storage(0);
+	curr_pos += size;
+
+	return EC_SUCCESS;
+}
+
+static void set_chunk_size(void)
+{
+}
+
+#else
+
+/* Largest chunk to read at once, if there is enough shared memory */
+#define MAX_CHUNK_SIZE 4096
+
+/* Use the biggest chunks which fit in shared memory, to cut per-read costs */
+static void set_chunk_size(void)
+{
+	int avail = shared_mem_size();
+
+	chunk_size = MAX_CHUNK_SIZE;
+	while (chunk_size > CHUNK_SIZE && chunk_size > avail)
+		chunk_size /= 2;
+}
+
+static int hash_next_chunk(void)
+{
+	int size = next_chunk_size(curr_pos);
 	char *buf;
 	int rv;
 
-	if (size == 0)
-		return EC_SUCCESS;
-
 	rv = shared_mem_acquire(size, &buf);
-	if (rv == EC_ERROR_BUSY) {
-		/* Couldn't update hash right now; try again later */
-		hook_call_deferred(&vboot_hash_next_chunk_data,
-				   WORK_INTERVAL_US);
+	if (rv != EC_SUCCESS)
 		return rv;
-	} else if (rv != EC_SUCCESS) {
-		vboot_hash_abort();
-		return rv;
-	}
 
-	rv = flash_read(offset, size, buf);
-	if (rv == EC_SUCCESS)
+	rv = flash_read(data_offset + curr_pos, size, buf);
+	if (rv == EC_SUCCESS) {
 		SHA256_update(&ctx, (const uint8_t *)buf, size);
-	else
-		vboot_hash_abort();
+		curr_pos += size;
+	}
 
 	shared_mem_release(buf);
 	return rv;
@@ -112,33 +284,39 @@ static int read_and_hash_chunk(int offset, int size)
 #define SHA256_PRINT_SIZE 4
 #endif
 
-static void hash_next_chunk(size_t size)
+/**
+ * Stop hashing, storing the final hash unless the hash failed or was aborted.
+ */
+static void vboot_hash_finish(bool success)
 {
-#ifdef CONFIG_MAPPED_STORAGE
-	flash_lock_mapped_storage(1);
-	SHA256_update(&ctx, (const uint8_t *)(CONFIG_MAPPED_STORAGE_BASE +
-					      data_offset + curr_pos), size);
-	flash_lock_mapped_storage(0);
-#else
-	if (read_and_hash_chunk(data_offset + curr_pos, size) != EC_SUCCESS)
-		return;
-#endif
+	if (success) {
+		hash = SHA256_final(&ctx);
+		hash_time_us = get_time().val - hash_start_time.val;
+		CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
+	}
+
+	in_progress = 0;
+	clock_enable_module(MODULE_FAST_CPU, 0);
+
+	/* Handle receiving abort during finalize */
+	if (!success || want_abort)
+		vboot_hash_abort();
 }
 
-static void vboot_hash_all_chunks(void)
+static int vboot_hash_all_chunks(void)
 {
-	do {
-		size_t size = MIN(CHUNK_SIZE, data_size - curr_pos);
-		hash_next_chunk(size);
-		curr_pos += size;
-	} while (curr_pos < data_size);
+	int rv = EC_SUCCESS;
 
-	hash = SHA256_final(&ctx);
-	CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
-	in_progress = 0;
-	clock_enable_module(MODULE_FAST_CPU, 0);
+	while (curr_pos < data_size) {
+		rv = hash_next_chunk();
+		if (rv != EC_SUCCESS)
+			break;
+		cache_save();
+	}
 
-	return;
+	vboot_hash_finish(rv == EC_SUCCESS);
+
+	return rv;
 }
 
 /**
@@ -146,34 +324,31 @@ static void vboot_hash_all_chunks(void)
  */
 static void vboot_hash_next_chunk(void)
 {
-	int size;
+	int rv;
 
 	/* Handle abort */
 	if (want_abort) {
-		in_progress = 0;
-		clock_enable_module(MODULE_FAST_CPU, 0);
-		vboot_hash_abort();
+		vboot_hash_finish(false);
 		return;
 	}
 
 	/* Compute the next chunk of hash */
-	size = MIN(CHUNK_SIZE, data_size - curr_pos);
-	hash_next_chunk(size);
+	if (curr_pos < data_size) {
+		rv = hash_next_chunk();
+		if (rv == EC_ERROR_BUSY) {
+			/* Couldn't update hash right now; try again later */
+			hook_call_deferred(&vboot_hash_next_chunk_data,
+					   WORK_INTERVAL_US);
+			return;
+		} else if (rv != EC_SUCCESS) {
+			vboot_hash_finish(false);
+			return;
+		}
+		cache_save();
+	}
 
-	curr_pos += size;
 	if (curr_pos >= data_size) {
-		/* Store the final hash */
-		hash = SHA256_final(&ctx);
-		CPRINTS("hash done %ph", HEX_BUF(hash, SHA256_PRINT_SIZE));
-
-		in_progress = 0;
-
-		clock_enable_module(MODULE_FAST_CPU, 0);
-
-		/* Handle receiving abort during finalize */
-		if (want_abort)
-			vboot_hash_abort();
-
+		vboot_hash_finish(true);
 		return;
 	}
 
@@ -221,18 +396,22 @@ static int vboot_hash_start(uint32_t offset, uint32_t size,
 	hash = NULL;
 	want_abort = 0;
 	in_progress = 1;
+	hash_start_time = get_time();
+	hash_time_us = 0;
+	set_chunk_size();
 
 	/* Restart the hash computation */
 	CPRINTS("hash start 0x%08x 0x%08x", offset, size);
 	SHA256_init(&ctx);
 	if (nonce_size)
 		SHA256_update(&ctx, nonce, nonce_size);
+	cache_start(offset, size, nonce_size);
+	resume_pos = curr_pos;
 
-	if (deferred)
-		hook_call_deferred(&vboot_hash_next_chunk_data, 0);
-	else
-		vboot_hash_all_chunks();
+	if (!deferred)
+		return vboot_hash_all_chunks();
 
+	hook_call_deferred(&vboot_hash_next_chunk_data, 0);
 	return EC_SUCCESS;
 }
 
@@ -277,12 +456,57 @@ static uint32_t get_rw_size(void)
 #endif
 }
 
+#if defined(CONFIG_SAVE_VBOOT_HASH) && defined(CONFIG_VBOOT_HASH_CACHE)
+/* Only the valid states are preserved, all of which must fit in a tag */
+BUILD_ASSERT(sizeof(struct vboot_hash_cache) <= 255);
+
+static int cache_tag_size(int valid)
+{
+	return offsetof(struct vboot_hash_cache, state) +
+		(valid - 1) * sizeof(cache.state[0]);
+}
+
+static void cache_restore(void)
+{
+	const struct vboot_hash_cache *tag;
+	int version, size;
+
+	tag = (const struct vboot_hash_cache *)system_get_jump_tag(
+		VBOOT_HASH_CACHE_SYSJUMP_TAG, &version, &size);
+	if (!tag || version != VBOOT_HASH_CACHE_SYSJUMP_VERSION ||
+	    size < cache_tag_size(1) || tag->valid < 1 ||
+	    tag->valid > CONFIG_VBOOT_HASH_CACHE ||
+	    size != cache_tag_size(tag->valid))
+		return;
+
+	memcpy(&cache, tag, size);
+}
+
+static void cache_preserve(void)
+{
+	if (cache.valid)
+		system_add_jump_tag(VBOOT_HASH_CACHE_SYSJUMP_TAG,
+				    VBOOT_HASH_CACHE_SYSJUMP_VERSION,
+				    cache_tag_size(cache.valid), &cache);
+}
+#else
+static inline void cache_restore(void)
+{
+}
+
+static inline void cache_preserve(void)
+{
+}
+#endif
+
 static void vboot_hash_init(void)
 {
 #ifdef CONFIG_SAVE_VBOOT_HASH
 	const struct vboot_hash_tag *tag;
 	int version, size;
 
+	cache_restore();
+
 	tag = (const struct vboot_hash_tag *)system_get_jump_tag(
 		VBOOT_HASH_SYSJUMP_TAG, &version, &size);
 	if (tag && version == VBOOT_HASH_SYSJUMP_VERSION &&
@@ -327,6 +551,9 @@ static int vboot_hash_preserve_state(void)
 {
 	struct vboot_hash_tag tag;
 
+	/* The cached states are good even if the hash is in progress */
+	cache_preserve();
+
 	/* If we haven't finished our hash, nothing to save */
 	if (!hash)
 		return EC_SUCCESS;
@@ -380,6 +607,16 @@ static int command_hash(int argc, char **argv)
 			ccprintf("%ph\n", HEX_BUF(hash, SHA256_DIGEST_SIZE));
 		else
 			ccprintf("(invalid)\n");
+		ccprintf("Chunk:  %d\n", chunk_size);
+		/* Not known for a hash preserved across sysjump */
+		if (hash && hash_time_us)
+			ccprintf("Time:   %d us (%d kB/s)\n", hash_time_us,
+				 (data_size - resume_pos) /
+				 MAX(hash_time_us / MSEC, 1));
+#ifdef CONFIG_VBOOT_HASH_CACHE
+		ccprintf("Cache:  %d/%d regions, resumed at 0x%x\n",
+			 cache.valid, CONFIG_VBOOT_HASH_CACHE, resume_pos);
+#endif
 
 		return EC_SUCCESS;
 	}
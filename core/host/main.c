@@ -40,6 +40,8 @@ static int test_main(void)
 
 	register_test_end_hook();
 
+	hook_init();
+
 	flash_pre_init();
 	system_pre_init();
 	system_common_pre_init();
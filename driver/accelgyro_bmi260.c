@@ -551,6 +551,7 @@ static int init(const struct motion_sensor_t *s)
 const struct accelgyro_drv bmi260_drv = {
 	.init = init,
 	.read = bmi_read,
+	.read_group = bmi_read_group,
 	.set_range = bmi_set_range,
 	.get_range = bmi_get_range,
 	.get_resolution = bmi_get_resolution,
@@ -769,6 +769,53 @@ int bmi_read(const struct motion_sensor_t *s, intv3_t v)
 	return EC_SUCCESS;
 }
 
+/*
+ * The status and aux/accel/gyro data registers fit in this many bytes, on
+ * both BMI160 (0x04..0x1b) and BMI260 (0x03..0x17).
+ */
+#define BMI_GROUP_READ_SIZE 24
+
+int bmi_read_group(const struct motion_sensor_t *s, uint32_t group)
+{
+	uint8_t data[BMI_GROUP_READ_SIZE];
+	const int status_reg = BMI_STATUS(V(s));
+	int first = status_reg, last = status_reg;
+	int i, reg, ret;
+	uint8_t status;
+
+	/* One burst covering the status and every sensor's data */
+	for (i = 0; i < motion_sensor_count; i++) {
+		if (!(group & BIT(i)))
+			continue;
+		reg = bmi_get_xyz_reg(&motion_sensors[i]);
+		if (reg < 0)
+			return EC_ERROR_INVAL;
+		first = MIN(first, reg);
+		last = MAX(last, reg + 5);
+	}
+	if (last - first + 1 > sizeof(data))
+		return EC_ERROR_INVAL;
+
+	ret = bmi_read_n(s->port, s->i2c_spi_addr_flags, first, data,
+			 last - first + 1);
+	if (ret != EC_SUCCESS) {
+		CPRINTS("%s: RD group 0x%x Error %d", s->name, group, ret);
+		return ret;
+	}
+
+	/* Sensors without new data keep their previous data */
+	status = data[status_reg - first];
+	for (i = 0; i < motion_sensor_count; i++) {
+		struct motion_sensor_t *g = &motion_sensors[i];
+
+		if (!(group & BIT(i)) || !(status & BMI_DRDY_MASK(g->type)))
+			continue;
+		bmi_normalize(g, g->raw_xyz,
+			      data + bmi_get_xyz_reg(g) - first);
+	}
+	return EC_SUCCESS;
+}
+
 int bmi_read_temp(const struct motion_sensor_t *s, int *temp_ptr)
 {
 	return bmi_get_sensor_temp(s - motion_sensors, temp_ptr);
@@ -316,6 +316,9 @@ int bmi_enable_fifo(const struct motion_sensor_t *s, int enable);
 /* Read the xyz data of accel/gyro */
 int bmi_read(const struct motion_sensor_t *s, intv3_t v);
 
+/* Read the xyz data of several sensors of the chip in one burst */
+int bmi_read_group(const struct motion_sensor_t *s, uint32_t group);
+
 /* Read temperature of sensor s */
 int bmi_read_temp(const struct motion_sensor_t *s, int *temp_ptr);
 
@@ -718,6 +718,48 @@ static int read(const struct motion_sensor_t *s, intv3_t v)
 	return EC_SUCCESS;
 }
 
+/*
+ * Read accel and gyro together: the status, temperature, gyro and accel
+ * output registers are contiguous, so one burst replaces a status read and
+ * a data read per sensor.
+ */
+static int read_group(const struct motion_sensor_t *s, uint32_t group)
+{
+	uint8_t raw[LSM6DSM_ACCEL_OUT_X_L_ADDR + OUT_XYZ_SIZE -
+		    LSM6DSM_STATUS_REG];
+	int i, ret;
+	uint8_t status;
+
+	for (i = 0; i < motion_sensor_count; i++)
+		if ((group & BIT(i)) &&
+		    motion_sensors[i].type != MOTIONSENSE_TYPE_ACCEL &&
+		    motion_sensors[i].type != MOTIONSENSE_TYPE_GYRO)
+			return EC_ERROR_INVAL;
+
+	ret = st_raw_read_n_noinc(s->port, s->i2c_spi_addr_flags,
+				  LSM6DSM_STATUS_REG, raw, sizeof(raw));
+	if (ret != EC_SUCCESS) {
+		CPRINTS("%s RD group 0x%x Error %d", s->name, group, ret);
+		return ret;
+	}
+
+	/* Sensors without new data keep their previous data */
+	status = raw[0];
+	for (i = 0; i < motion_sensor_count; i++) {
+		struct motion_sensor_t *g = &motion_sensors[i];
+
+		if (!(group & BIT(i)))
+			continue;
+		if (g->type == MOTIONSENSE_TYPE_ACCEL ?
+		    !(status & LSM6DSM_STS_XLDA_MASK) :
+		    !(status & LSM6DSM_STS_GDA_MASK))
+			continue;
+		st_normalize(g, g->raw_xyz,
+			     raw + get_xyz_reg(g->type) - LSM6DSM_STATUS_REG);
+	}
+	return EC_SUCCESS;
+}
+
 static int init(const struct motion_sensor_t *s)
 {
 	int ret = 0, tmp;
@@ -854,6 +896,7 @@ static int read_temp(const struct motion_sensor_t *s, int *temp)
 const struct accelgyro_drv lsm6dsm_drv = {
 	.init = init,
 	.read = read,
+	.read_group = read_group,
 	.set_range = set_range,
 	.get_range = get_range,
 	.get_resolution = st_get_resolution,
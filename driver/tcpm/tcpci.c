@@ -107,12 +107,232 @@ static int tcpc_vbus[CONFIG_USB_PD_PORT_MAX_COUNT];
 /* Cached RP role values */
 static int cached_rp[CONFIG_USB_PD_PORT_MAX_COUNT];
 
-#ifdef CONFIG_USB_PD_TCPC_LOW_POWER
+#ifdef CONFIG_USB_PD_TCPC_REG_CACHE
+/*
+ * Shadow cache of the TCPCI registers which only the TCPM ever writes.  The
+ * TCPC never changes these on its own, so once a value has been read or
+ * written it can be answered locally, and mask updates become a single write.
+ * Status, alert, command and buffer registers are volatile and always go to
+ * the TCPC.  The exceptions are RECEIVE_DETECT, which the TCPC clears on a
+ * Hard Reset, and POWER_CONTROL, which it may change on a fault; both are
+ * forgotten when the alert reports one.
+ */
+#define REG_CACHE_FIRST TCPC_REG_ALERT_MASK
+#define REG_CACHE_LAST TCPC_REG_RX_DETECT
+#define REG_CACHE_SIZE (REG_CACHE_LAST - REG_CACHE_FIRST + 1)
+#define REG_CACHE_BIT(reg) BIT((reg) - REG_CACHE_FIRST)
+
+BUILD_ASSERT(REG_CACHE_SIZE <= 32);
+
+static const uint32_t reg_cache_cacheable =
+	REG_CACHE_BIT(TCPC_REG_ALERT_MASK) |
+	REG_CACHE_BIT(TCPC_REG_ALERT_MASK + 1) |
+	REG_CACHE_BIT(TCPC_REG_POWER_STATUS_MASK) |
+	REG_CACHE_BIT(TCPC_REG_FAULT_STATUS_MASK) |
+	REG_CACHE_BIT(TCPC_REG_EXT_STATUS_MASK) |
+	REG_CACHE_BIT(TCPC_REG_ALERT_EXTENDED_MASK) |
+	REG_CACHE_BIT(TCPC_REG_CONFIG_STD_OUTPUT) |
+	REG_CACHE_BIT(TCPC_REG_TCPC_CTRL) |
+	REG_CACHE_BIT(TCPC_REG_ROLE_CTRL) |
+	REG_CACHE_BIT(TCPC_REG_FAULT_CTRL) |
+	REG_CACHE_BIT(TCPC_REG_POWER_CTRL) |
+	REG_CACHE_BIT(TCPC_REG_MSG_HDR_INFO) |
+	REG_CACHE_BIT(TCPC_REG_RX_DETECT);
+
+/*
+ * More than one task may access a port's registers, so the valid bits are
+ * only changed atomically.
+ */
+static struct {
+	/* Registers holding a known value, as REG_CACHE_BIT()s */
+	uint32_t valid;
+	uint8_t val[REG_CACHE_SIZE];
+} reg_cache[CONFIG_USB_PD_PORT_MAX_COUNT];
+
+/*
+ * Ports which have been through tcpci_tcpm_init(), so their register map is
+ * known to be TCPCI.
+ */
+static uint32_t reg_cache_enabled;
+
+/* Reset the cache of a port whose TCPC is being (re)initialized */
+static void reg_cache_reset(int port)
+{
+	atomic_clear(&reg_cache[port].valid, UINT32_MAX);
+	atomic_or(&reg_cache_enabled, BIT(port));
+}
+
+/* Forget any cached registers in [reg, reg + size) */
+static void reg_cache_forget(int port, int reg, int size)
+{
+	int first = MAX(reg, REG_CACHE_FIRST);
+	int last = MIN(reg + size - 1, REG_CACHE_LAST);
+
+	if (first <= last)
+		atomic_clear(&reg_cache[port].valid,
+			     (BIT(last - first + 1) - 1) <<
+			     (first - REG_CACHE_FIRST));
+}
+
+/*
+ * Return the cache bits for a size byte access to reg, or 0 if the access
+ * cannot be cached.
+ */
+static uint32_t reg_cache_bits(int port, int i2c_addr, int reg, int size)
+{
+	uint32_t bits;
+
+	if (!(reg_cache_enabled & BIT(port)) ||
+	    i2c_addr != tcpc_config[port].i2c_info.addr_flags ||
+	    reg < REG_CACHE_FIRST || reg + size - 1 > REG_CACHE_LAST)
+		return 0;
+
+	bits = (BIT(size) - 1) << (reg - REG_CACHE_FIRST);
+	return (bits & reg_cache_cacheable) == bits ? bits : 0;
+}
+
+/* Return 1 and the value if a size byte access to reg is cached */
+static int reg_cache_read(int port, int i2c_addr, int reg, int size,
+			  int *val)
+{
+	uint32_t bits = reg_cache_bits(port, i2c_addr, reg, size);
+	const uint8_t *v = reg_cache[port].val + reg - REG_CACHE_FIRST;
+
+	if (!bits || (reg_cache[port].valid & bits) != bits)
+		return 0;
+
+	*val = size == 2 ? v[0] | v[1] << 8 : v[0];
+	return 1;
+}
+
+/* Record the result of reading or writing val to reg */
+static void reg_cache_update(int port, int i2c_addr, int reg, int size,
+			     int val, int rv)
+{
+	uint32_t bits = reg_cache_bits(port, i2c_addr, reg, size);
+	uint8_t *v = reg_cache[port].val + reg - REG_CACHE_FIRST;
+
+	if (!bits)
+		return;
+
+	/*
+	 * Don't answer reads while the value changes.  The register state is
+	 * unknown after a failed transfer.
+	 */
+	atomic_clear(&reg_cache[port].valid, bits);
+	if (rv)
+		return;
+
+	v[0] = val;
+	if (size == 2)
+		v[1] = val >> 8;
+	atomic_or(&reg_cache[port].valid, bits);
+}
+
+/* Forget anything a raw transfer may have written */
+static void reg_cache_xfer(int port, const uint8_t *out, int out_size,
+			   int flags)
+{
+	if (!out_size)
+		return;
+
+	/* Writes without a register address may land anywhere */
+	if (flags & I2C_XFER_START)
+		reg_cache_forget(port, out[0], out_size - 1);
+	else
+		atomic_clear(&reg_cache[port].valid, UINT32_MAX);
+}
+
+/*
+ * Read-modify-write a cacheable register.  The read is answered from the
+ * cache when possible, so this is usually a single write, or nothing.
+ */
+static int reg_cache_rmw(int port, int i2c_addr, int reg, int size,
+			 int mask, enum mask_update_action action)
+{
+	const int i2c_port = tcpc_config[port].i2c_info.port;
+	int read_val;
+	int write_val;
+	int rv;
+
+	if (!reg_cache_read(port, i2c_addr, reg, size, &read_val)) {
+		rv = size == 2 ?
+			i2c_read16(i2c_port, i2c_addr, reg, &read_val) :
+			i2c_read8(i2c_port, i2c_addr, reg, &read_val);
+		reg_cache_update(port, i2c_addr, reg, size, read_val, rv);
+		if (rv)
+			return rv;
+	}
+
+	write_val = (action == MASK_SET) ? (read_val | mask)
+					 : (read_val & ~mask);
+
+	if (IS_ENABLED(CONFIG_I2C_UPDATE_IF_CHANGED) && write_val == read_val)
+		return EC_SUCCESS;
+
+	rv = size == 2 ? i2c_write16(i2c_port, i2c_addr, reg, write_val) :
+			 i2c_write8(i2c_port, i2c_addr, reg, write_val);
+	reg_cache_update(port, i2c_addr, reg, size, write_val, rv);
+	return rv;
+}
+#else
+static inline void reg_cache_reset(int port)
+{
+}
+
+static inline void reg_cache_forget(int port, int reg, int size)
+{
+}
+
+static inline int reg_cache_bits(int port, int i2c_addr, int reg, int size)
+{
+	return 0;
+}
+
+static inline int reg_cache_read(int port, int i2c_addr, int reg, int size,
+				 int *val)
+{
+	return 0;
+}
+
+static inline void reg_cache_update(int port, int i2c_addr, int reg,
+				    int size, int val, int rv)
+{
+}
+
+static inline void reg_cache_xfer(int port, const uint8_t *out, int out_size,
+				  int flags)
+{
+}
+
+static inline int reg_cache_rmw(int port, int i2c_addr, int reg, int size,
+				int mask, enum mask_update_action action)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+#endif /* CONFIG_USB_PD_TCPC_REG_CACHE */
+
+#if defined(CONFIG_USB_PD_TCPC_LOW_POWER) || \
+	defined(CONFIG_USB_PD_TCPC_REG_CACHE)
+/* Wake the TCPC, if it is in low power mode, before accessing it */
+static inline void tcpc_access_begin(int port)
+{
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_LOW_POWER))
+		pd_wait_exit_low_power(port);
+}
+
+/* Let the PD task know the TCPC was accessed, to delay low power mode */
+static inline void tcpc_access_end(int port)
+{
+	if (IS_ENABLED(CONFIG_USB_PD_TCPC_LOW_POWER))
+		pd_device_accessed(port);
+}
+
 int tcpc_addr_write(int port, int i2c_addr, int reg, int val)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	if (IS_ENABLED(DEBUG_I2C_FAULT_LAST_WRITE_OP)) {
 		last_write_op[port].addr = i2c_addr;
@@ -123,8 +343,9 @@ int tcpc_addr_write(int port, int i2c_addr, int reg, int val)
 
 	rv = i2c_write8(tcpc_config[port].i2c_info.port,
 			i2c_addr, reg, val);
+	reg_cache_update(port, i2c_addr, reg, 1, val, rv);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -132,7 +353,7 @@ int tcpc_addr_write16(int port, int i2c_addr, int reg, int val)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	if (IS_ENABLED(DEBUG_I2C_FAULT_LAST_WRITE_OP)) {
 		last_write_op[port].addr = i2c_addr;
@@ -143,8 +364,9 @@ int tcpc_addr_write16(int port, int i2c_addr, int reg, int val)
 
 	rv = i2c_write16(tcpc_config[port].i2c_info.port,
 			 i2c_addr, reg, val);
+	reg_cache_update(port, i2c_addr, reg, 2, val, rv);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -152,12 +374,17 @@ int tcpc_addr_read(int port, int i2c_addr, int reg, int *val)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	/* A cached register doesn't need the TCPC awake */
+	if (reg_cache_read(port, i2c_addr, reg, 1, val))
+		return EC_SUCCESS;
+
+	tcpc_access_begin(port);
 
 	rv = i2c_read8(tcpc_config[port].i2c_info.port,
 		       i2c_addr, reg, val);
+	reg_cache_update(port, i2c_addr, reg, 1, *val, rv);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -165,12 +392,17 @@ int tcpc_addr_read16(int port, int i2c_addr, int reg, int *val)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	/* A cached register doesn't need the TCPC awake */
+	if (reg_cache_read(port, i2c_addr, reg, 2, val))
+		return EC_SUCCESS;
+
+	tcpc_access_begin(port);
 
 	rv = i2c_read16(tcpc_config[port].i2c_info.port,
 			i2c_addr, reg, val);
+	reg_cache_update(port, i2c_addr, reg, 2, *val, rv);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -178,13 +410,13 @@ int tcpc_read_block(int port, int reg, uint8_t *in, int size)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	rv = i2c_read_block(tcpc_config[port].i2c_info.port,
 			    tcpc_config[port].i2c_info.addr_flags,
 			    reg, in, size);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -192,13 +424,14 @@ int tcpc_write_block(int port, int reg, const uint8_t *out, int size)
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	rv = i2c_write_block(tcpc_config[port].i2c_info.port,
 			     tcpc_config[port].i2c_info.addr_flags,
 			     reg, out, size);
+	reg_cache_forget(port, reg, size);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -219,13 +452,14 @@ int tcpc_xfer_unlocked(int port, const uint8_t *out, int out_size,
 {
 	int rv;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	rv = i2c_xfer_unlocked(tcpc_config[port].i2c_info.port,
 			       tcpc_config[port].i2c_info.addr_flags,
 			       out, out_size, in, in_size, flags);
+	reg_cache_xfer(port, out, out_size, flags);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -236,7 +470,7 @@ int tcpc_update8(int port, int reg,
 	int rv;
 	const int i2c_addr = tcpc_config[port].i2c_info.addr_flags;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	if (IS_ENABLED(DEBUG_I2C_FAULT_LAST_WRITE_OP)) {
 		last_write_op[port].addr = i2c_addr;
@@ -245,10 +479,13 @@ int tcpc_update8(int port, int reg,
 		last_write_op[port].mask = (mask & 0xFF) | (action << 16);
 	}
 
-	rv = i2c_update8(tcpc_config[port].i2c_info.port,
-			 i2c_addr, reg, mask, action);
+	if (reg_cache_bits(port, i2c_addr, reg, 1))
+		rv = reg_cache_rmw(port, i2c_addr, reg, 1, mask, action);
+	else
+		rv = i2c_update8(tcpc_config[port].i2c_info.port,
+				 i2c_addr, reg, mask, action);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
@@ -259,7 +496,7 @@ int tcpc_update16(int port, int reg,
 	int rv;
 	const int i2c_addr = tcpc_config[port].i2c_info.addr_flags;
 
-	pd_wait_exit_low_power(port);
+	tcpc_access_begin(port);
 
 	if (IS_ENABLED(DEBUG_I2C_FAULT_LAST_WRITE_OP)) {
 		last_write_op[port].addr = i2c_addr;
@@ -268,14 +505,17 @@ int tcpc_update16(int port, int reg,
 		last_write_op[port].mask = (mask & 0xFFFF) | (action << 16);
 	}
 
-	rv = i2c_update16(tcpc_config[port].i2c_info.port,
-			  i2c_addr, reg, mask, action);
+	if (reg_cache_bits(port, i2c_addr, reg, 2))
+		rv = reg_cache_rmw(port, i2c_addr, reg, 2, mask, action);
+	else
+		rv = i2c_update16(tcpc_config[port].i2c_info.port,
+				  i2c_addr, reg, mask, action);
 
-	pd_device_accessed(port);
+	tcpc_access_end(port);
 	return rv;
 }
 
-#endif /* CONFIG_USB_PD_TCPC_LOW_POWER */
+#endif /* CONFIG_USB_PD_TCPC_LOW_POWER || CONFIG_USB_PD_TCPC_REG_CACHE */
 
 /*
  * TCPCI maintains and uses cached values for the RP and
@@ -406,26 +646,12 @@ int tcpci_tcpc_debug_accessory(int port, bool enable)
 			    enable ? MASK_CLR : MASK_SET);
 }
 
-int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
-	enum tcpc_cc_voltage_status *cc2)
+/* Decode the CC lines from the ROLE CONTROL and CC STATUS values */
+static void tcpci_decode_cc(int port, int role, int status,
+			    enum tcpc_cc_voltage_status *cc1,
+			    enum tcpc_cc_voltage_status *cc2)
 {
-	int role;
-	int status;
 	int cc1_present_rd, cc2_present_rd;
-	int rv;
-
-	/* errors will return CC as open */
-	*cc1 = TYPEC_CC_VOLT_OPEN;
-	*cc2 = TYPEC_CC_VOLT_OPEN;
-
-	/* Get the ROLE CONTROL and CC STATUS values */
-	rv = tcpc_read(port, TCPC_REG_ROLE_CTRL, &role);
-	if (rv)
-		return rv;
-
-	rv = tcpc_read(port, TCPC_REG_CC_STATUS, &status);
-	if (rv)
-		return rv;
 
 	/* Get the current CC values from the CC STATUS */
 	*cc1 = TCPC_REG_CC_STATUS_CC1(status);
@@ -480,6 +706,29 @@ int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
 		last_get_cc[port].cc_sts = status;
 		last_get_cc[port].role = role;
 	}
+}
+
+int tcpci_tcpm_get_cc(int port, enum tcpc_cc_voltage_status *cc1,
+	enum tcpc_cc_voltage_status *cc2)
+{
+	int role;
+	int status;
+	int rv;
+
+	/* errors will return CC as open */
+	*cc1 = TYPEC_CC_VOLT_OPEN;
+	*cc2 = TYPEC_CC_VOLT_OPEN;
+
+	/* Get the ROLE CONTROL and CC STATUS values */
+	rv = tcpc_read(port, TCPC_REG_ROLE_CTRL, &role);
+	if (rv)
+		return rv;
+
+	rv = tcpc_read(port, TCPC_REG_CC_STATUS, &status);
+	if (rv)
+		return rv;
+
+	tcpci_decode_cc(port, role, status, cc1, cc2);
 	return rv;
 }
 
@@ -790,8 +1039,17 @@ static int tcpci_rev1_0_tcpm_get_message_raw(int port, uint32_t *payload,
 {
 	int rv, cnt, reg = TCPC_REG_RX_DATA;
 	int frm;
-
-	rv = tcpc_read(port, TCPC_REG_RX_BYTE_CNT, &cnt);
+	const bool block_read = tcpc_config[port].flags & TCPC_FLAGS_BLOCK_READ;
+	uint8_t rx[TCPC_REG_RX_DATA - TCPC_REG_RX_BYTE_CNT];
+
+	if (block_read) {
+		/* Byte count, frame type and header in one go */
+		rv = tcpc_read_block(port, TCPC_REG_RX_BYTE_CNT, rx, sizeof(rx));
+		cnt = rx[0];
+		frm = rx[1];
+	} else {
+		rv = tcpc_read(port, TCPC_REG_RX_BYTE_CNT, &cnt);
+	}
 
 	/* RX_BYTE_CNT includes 3 bytes for frame type and header */
 	if (rv != EC_SUCCESS || cnt < 3) {
@@ -804,7 +1062,7 @@ static int tcpci_rev1_0_tcpm_get_message_raw(int port, uint32_t *payload,
 		goto clear;
 	}
 
-	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP)) {
+	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP) && !block_read) {
 		rv = tcpc_read(port, TCPC_REG_RX_BUF_FRAME_TYPE, &frm);
 		if (rv != EC_SUCCESS) {
 			rv = EC_ERROR_UNKNOWN;
@@ -812,7 +1070,10 @@ static int tcpci_rev1_0_tcpm_get_message_raw(int port, uint32_t *payload,
 		}
 	}
 
-	rv = tcpc_read16(port, TCPC_REG_RX_HDR, (int *)head);
+	if (block_read)
+		*head = UINT16_FROM_BYTE_ARRAY_LE(rx, 2);
+	else
+		rv = tcpc_read16(port, TCPC_REG_RX_HDR, (int *)head);
 
 	if (IS_ENABLED(CONFIG_USB_PD_DECODE_SOP)) {
 		/* Encode message address in bits 31 to 28 */
@@ -886,7 +1147,7 @@ int tcpm_enqueue_message(const int port)
 	atomic_add(&q->head, 1);
 
 	/* Wake PD task up so it can process incoming RX messages */
-	task_set_event(PD_PORT_TO_TASK_ID(port), TASK_EVENT_WAKE, 0);
+	pd_task_set_event(port, TASK_EVENT_WAKE);
 
 	return EC_SUCCESS;
 }
@@ -1009,6 +1270,10 @@ static int register_mask_reset(int port)
 {
 	int mask;
 
+	/* These reads must reach the TCPC to tell whether it has reset */
+	reg_cache_forget(port, TCPC_REG_ALERT_MASK, 2);
+	reg_cache_forget(port, TCPC_REG_POWER_STATUS_MASK, 1);
+
 	mask = 0;
 	tcpc_read16(port, TCPC_REG_ALERT_MASK, &mask);
 	if (mask == TCPC_REG_ALERT_MASK_ALL)
@@ -1067,7 +1332,8 @@ static int tcpci_clear_fault(int port, int fault)
 	return tcpc_write16(port, TCPC_REG_ALERT, TCPC_REG_ALERT_FAULT);
 }
 
-static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
+static void tcpci_vbus_changed(int port, int alert, int ext_status,
+			       int pwr_status, uint32_t *pd_event)
 {
 	/*
 	 * Check for VBus change
@@ -1075,20 +1341,14 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 	/* TCPCI Rev2 includes Safe0V detection */
 	if (TCPC_FLAGS_VSAFE0V(tcpc_config[port].flags) &&
 	    (alert & TCPC_REG_ALERT_EXT_STATUS)) {
-		int ext_status = 0;
-
 		/* Determine if Safe0V was detected */
-		tcpm_ext_status(port, &ext_status);
 		if (ext_status & TCPC_REG_EXT_STATUS_SAFE0V)
 			/* Safe0V=1 and Present=0 */
 			tcpc_vbus[port] = BIT(VBUS_SAFE0V);
 	}
 
 	if (alert & TCPC_REG_ALERT_POWER_STATUS) {
-		int pwr_status = 0;
-
 		/* Determine reason for power status change */
-		tcpci_tcpm_get_power_status(port, &pwr_status);
 		if (pwr_status & TCPC_REG_POWER_STATUS_VBUS_PRES)
 			/* Safe0V=0 and Present=1 */
 			tcpc_vbus[port] = BIT(VBUS_PRESENT);
@@ -1120,18 +1380,65 @@ static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
 	}
 }
 
+static void tcpci_check_vbus_changed(int port, int alert, uint32_t *pd_event)
+{
+	int ext_status = 0;
+	int pwr_status = 0;
+
+	if (TCPC_FLAGS_VSAFE0V(tcpc_config[port].flags) &&
+	    (alert & TCPC_REG_ALERT_EXT_STATUS))
+		tcpm_ext_status(port, &ext_status);
+
+	if (alert & TCPC_REG_ALERT_POWER_STATUS)
+		tcpci_tcpm_get_power_status(port, &pwr_status);
+
+	tcpci_vbus_changed(port, alert, ext_status, pwr_status, pd_event);
+}
+
 /*
  * Don't let the TCPC try to pull from the RX buffer forever. We typical only
  * have 1 or 2 messages waiting.
  */
 #define MAX_ALLOW_FAILED_RX_READS 10
 
-void tcpci_tcpc_alert(int port)
+/*
+ * TCPCs with TCPC_FLAGS_BLOCK_READ read ALERT by itself, then fetch the other
+ * registers an alert needs in block reads: FAULT_STATUS..ALERT_EXT when a
+ * fault or extended alert is pending, and after the alert bits are cleared,
+ * ALERT_MASK..EXT_STATUS for a status change or just the masks otherwise.
+ * Reading the status registers last means that a change after the read raises
+ * a new alert.
+ */
+#define FAULT_BLOCK_SIZE	(TCPC_REG_ALERT_EXT - TCPC_REG_FAULT_STATUS + 1)
+#define FAULT_BLOCK_REG(block, reg)	((block)[(reg) - TCPC_REG_FAULT_STATUS])
+#define STATUS_BLOCK_SIZE	(TCPC_REG_EXT_STATUS - TCPC_REG_ALERT_MASK + 1)
+#define MASK_BLOCK_SIZE	(TCPC_REG_POWER_STATUS_MASK - TCPC_REG_ALERT_MASK + 1)
+#define STATUS_BLOCK_REG(block, reg)	((block)[(reg) - TCPC_REG_ALERT_MASK])
+#define ALERT_STATUS_CHANGE	(TCPC_REG_ALERT_CC_STATUS | \
+				 TCPC_REG_ALERT_POWER_STATUS | \
+				 TCPC_REG_ALERT_EXT_STATUS)
+
+#ifdef CONFIG_CMD_TCPC_ALERT_STATS
+/* Time spent servicing alerts, since the last tcpcstats command */
+struct tcpc_alert_stats {
+	uint32_t count;
+	uint32_t max_us;
+	uint64_t total_us;
+};
+static struct tcpc_alert_stats alert_stats[CONFIG_USB_PD_PORT_MAX_COUNT];
+#endif
+
+static void tcpci_service_alert(int port)
 {
+	const bool block_read = tcpc_config[port].flags & TCPC_FLAGS_BLOCK_READ;
+	uint8_t fault_block[FAULT_BLOCK_SIZE];
+	uint8_t status_block[STATUS_BLOCK_SIZE] = { 0 };
 	int alert = 0;
 	int alert_ext = 0;
+	int fault = 0;
 	int failed_attempts;
 	uint32_t pd_event = 0;
+	int rv;
 
 	/* Read the Alert register from the TCPC */
 	if (tcpm_alert_status(port, &alert)) {
@@ -1139,20 +1446,45 @@ void tcpci_tcpc_alert(int port)
 		return;
 	}
 
-	/* Get Extended Alert register if needed */
-	if (alert & TCPC_REG_ALERT_ALERT_EXT)
-		tcpm_alert_ext_status(port, &alert_ext);
+	/* Get the Fault and Extended Alert registers if needed */
+	if (block_read &&
+	    (alert & (TCPC_REG_ALERT_FAULT | TCPC_REG_ALERT_ALERT_EXT))) {
+		rv = tcpc_read_block(port, TCPC_REG_FAULT_STATUS, fault_block,
+				     sizeof(fault_block));
+		if (rv == EC_SUCCESS) {
+			fault = FAULT_BLOCK_REG(fault_block,
+						TCPC_REG_FAULT_STATUS);
+			if (alert & TCPC_REG_ALERT_ALERT_EXT)
+				alert_ext = FAULT_BLOCK_REG(fault_block,
+							    TCPC_REG_ALERT_EXT);
+		}
+	} else {
+		rv = EC_SUCCESS;
+		if (alert & TCPC_REG_ALERT_ALERT_EXT)
+			tcpm_alert_ext_status(port, &alert_ext);
+		if (alert & TCPC_REG_ALERT_FAULT)
+			rv = tcpci_get_fault(port, &fault);
+	}
+
+	/*
+	 * On a Hard Reset, received or sent (TX success and failed together),
+	 * the TCPC disables its receiver, and on a fault it may turn off VCONN
+	 * or a discharge, so the cached copies are stale.
+	 */
+	if ((alert & (TCPC_REG_ALERT_RX_HARD_RST | TCPC_REG_ALERT_FAULT)) ||
+	    (alert & TCPC_REG_ALERT_TX_SUCCESS &&
+	     alert & TCPC_REG_ALERT_TX_FAILED)) {
+		reg_cache_forget(port, TCPC_REG_RX_DETECT, 1);
+		reg_cache_forget(port, TCPC_REG_POWER_CTRL, 1);
+	}
 
 	/* Clear any pending faults */
-	if (alert & TCPC_REG_ALERT_FAULT) {
-		int fault;
-
-		if (tcpci_get_fault(port, &fault) == EC_SUCCESS &&
-		    fault != 0 &&
-		    tcpci_handle_fault(port, fault) == EC_SUCCESS &&
-		    tcpci_clear_fault(port, fault) == EC_SUCCESS)
-			CPRINTS("C%d FAULT 0x%02X handled", port, fault);
-	}
+	if ((alert & TCPC_REG_ALERT_FAULT) &&
+	    rv == EC_SUCCESS &&
+	    fault != 0 &&
+	    tcpci_handle_fault(port, fault) == EC_SUCCESS &&
+	    tcpci_clear_fault(port, fault) == EC_SUCCESS)
+		CPRINTS("C%d FAULT 0x%02X handled", port, fault);
 
 	/*
 	 * Check for TX complete first b/c PD state machine waits on TX
@@ -1196,6 +1528,13 @@ void tcpci_tcpc_alert(int port)
 	if (alert)
 		tcpc_write16(port, TCPC_REG_ALERT, alert);
 
+	/* A failed read leaves CC open, no VBUS change and no TCPC reset */
+	if (block_read &&
+	    tcpc_read_block(port, TCPC_REG_ALERT_MASK, status_block,
+			    alert & ALERT_STATUS_CHANGE ?
+				STATUS_BLOCK_SIZE : MASK_BLOCK_SIZE))
+		memset(status_block, 0, sizeof(status_block));
+
 	if (alert & TCPC_REG_ALERT_CC_STATUS) {
 		if (IS_ENABLED(CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE)) {
 			enum tcpc_cc_voltage_status cc1;
@@ -1208,7 +1547,15 @@ void tcpci_tcpc_alert(int port)
 			 * CC line status and only generate a
 			 * PD_EVENT_CC if something is connected.
 			 */
-			tcpci_tcpm_get_cc(port, &cc1, &cc2);
+			if (block_read)
+				tcpci_decode_cc(port,
+					STATUS_BLOCK_REG(status_block,
+							 TCPC_REG_ROLE_CTRL),
+					STATUS_BLOCK_REG(status_block,
+							 TCPC_REG_CC_STATUS),
+					&cc1, &cc2);
+			else
+				tcpci_tcpm_get_cc(port, &cc1, &cc2);
 			if (cc1 != TYPEC_CC_VOLT_OPEN ||
 			    cc2 != TYPEC_CC_VOLT_OPEN)
 				/* CC status cchanged, wake task */
@@ -1219,7 +1566,13 @@ void tcpci_tcpc_alert(int port)
 		}
 	}
 
-	tcpci_check_vbus_changed(port, alert, &pd_event);
+	if (block_read)
+		tcpci_vbus_changed(port, alert,
+			STATUS_BLOCK_REG(status_block, TCPC_REG_EXT_STATUS),
+			STATUS_BLOCK_REG(status_block, TCPC_REG_POWER_STATUS),
+			&pd_event);
+	else
+		tcpci_check_vbus_changed(port, alert, &pd_event);
 
 	/* Check for Hard Reset received */
 	if (alert & TCPC_REG_ALERT_RX_HARD_RST) {
@@ -1246,7 +1599,15 @@ void tcpci_tcpc_alert(int port)
 	 * Check registers to see if we can tell that the TCPC has reset. If
 	 * so, perform a tcpc_init.
 	 */
-	if (register_mask_reset(port))
+	if (block_read)
+		rv = UINT16_FROM_BYTE_ARRAY_LE(status_block, 0) ==
+					TCPC_REG_ALERT_MASK_ALL ||
+		     STATUS_BLOCK_REG(status_block,
+				      TCPC_REG_POWER_STATUS_MASK) ==
+					TCPC_REG_POWER_STATUS_MASK_ALL;
+	else
+		rv = register_mask_reset(port);
+	if (rv)
 		pd_event |= PD_EVENT_TCPC_RESET;
 
 	/*
@@ -1257,9 +1618,60 @@ void tcpci_tcpc_alert(int port)
 	 * the next I2C transaction to the TCPC will cause it to wake again.
 	 */
 	if (pd_event)
-		task_set_event(PD_PORT_TO_TASK_ID(port), pd_event, 0);
+		pd_task_set_event(port, pd_event);
 }
 
+void tcpci_tcpc_alert(int port)
+{
+#ifdef CONFIG_CMD_TCPC_ALERT_STATS
+	const timestamp_t start = get_time();
+	uint32_t service_us;
+
+	tcpci_service_alert(port);
+
+	service_us = get_time().val - start.val;
+	interrupt_disable();
+	alert_stats[port].count++;
+	alert_stats[port].total_us += service_us;
+	alert_stats[port].max_us = MAX(alert_stats[port].max_us, service_us);
+	interrupt_enable();
+#else
+	tcpci_service_alert(port);
+#endif
+}
+
+#ifdef CONFIG_CMD_TCPC_ALERT_STATS
+static int command_tcpc_alert_stats(int argc, char **argv)
+{
+	struct tcpc_alert_stats stats[CONFIG_USB_PD_PORT_MAX_COUNT];
+	int port;
+
+	/*
+	 * Take the stats and start a new measurement window in one step, so an
+	 * alert serviced meanwhile is neither torn nor lost.
+	 */
+	interrupt_disable();
+	memcpy(stats, alert_stats, sizeof(stats));
+	memset(alert_stats, 0, sizeof(alert_stats));
+	interrupt_enable();
+
+	ccprintf("Port  Alerts  Avg us  Max us\n");
+	for (port = 0; port < board_get_usb_pd_port_count(); port++) {
+		uint64_t avg_us = stats[port].total_us;
+
+		if (stats[port].count)
+			uint64divmod(&avg_us, (int)stats[port].count);
+		ccprintf("C%d    %6u  %6u  %6u\n", port,
+			 stats[port].count, (uint32_t)avg_us,
+			 stats[port].max_us);
+	}
+
+	return EC_SUCCESS;
+}
+DECLARE_SAFE_CONSOLE_COMMAND(tcpcstats, command_tcpc_alert_stats, NULL,
+			     "Print and reset TCPC alert service times");
+#endif /* CONFIG_CMD_TCPC_ALERT_STATS */
+
 /*
  * This call will wake up the TCPC if it is in low power mode upon accessing the
  * i2c bus (but the pd state machine should put it back into low power mode).
@@ -1349,6 +1761,40 @@ int tcpci_tcpm_release(int port)
  * in order to allow the TCPC time to boot / reset.
  */
 #define TCPM_INIT_TRIES 30
+#define TCPM_INIT_RETRY_DELAY (10 * MSEC)
+
+#ifdef CONFIG_USB_PD_SHARED_TASK
+/*
+ * The shared PD task services every port, so it mustn't sleep while a TCPC
+ * boots.  Init returns EC_ERROR_BUSY instead, and the caller tries again
+ * later, until this deadline passes.
+ */
+static uint64_t init_deadline[CONFIG_USB_PD_PORT_MAX_COUNT];
+#endif
+
+/*
+ * The TCPC isn't ready yet: wait and return EC_SUCCESS to try again, or
+ * return the error to give up with.
+ */
+static int tcpm_init_retry(int port, int *tries, int error)
+{
+#ifdef CONFIG_USB_PD_SHARED_TASK
+	uint64_t now = get_time().val;
+
+	if (!init_deadline[port])
+		init_deadline[port] = now +
+				      TCPM_INIT_TRIES * TCPM_INIT_RETRY_DELAY;
+	if (now < init_deadline[port])
+		return EC_ERROR_BUSY;
+	init_deadline[port] = 0;
+	return error ? error : EC_ERROR_TIMEOUT;
+#else
+	if (--*tries <= 0)
+		return error ? error : EC_ERROR_TIMEOUT;
+	msleep(TCPM_INIT_RETRY_DELAY / MSEC);
+	return EC_SUCCESS;
+#endif
+}
 
 int tcpci_tcpm_init(int port)
 {
@@ -1360,6 +1806,9 @@ int tcpci_tcpm_init(int port)
 	if (port >= board_get_usb_pd_port_count())
 		return EC_ERROR_INVAL;
 
+	/* Nothing cached from before a reset can be trusted */
+	reg_cache_reset(port);
+
 	while (1) {
 		error = tcpci_tcpm_get_power_status(port, &power_status);
 		/*
@@ -1369,10 +1818,13 @@ int tcpci_tcpm_init(int port)
 		 */
 		if (!error && !(power_status & TCPC_REG_POWER_STATUS_UNINIT))
 			break;
-		if (--tries <= 0)
-			return error ? error : EC_ERROR_TIMEOUT;
-		msleep(10);
+		error = tcpm_init_retry(port, &tries, error);
+		if (error)
+			return error;
 	}
+#ifdef CONFIG_USB_PD_SHARED_TASK
+	init_deadline[port] = 0;
+#endif
 
 	/*
 	 * Set TCPC_CONTROL.DebugAccessoryControl = 1 to control by TCPM,
@@ -1465,6 +1917,12 @@ int tcpci_tcpm_mux_init(const struct usb_mux *me)
 		 */
 		if (!error && !(power_status & TCPC_REG_POWER_STATUS_UNINIT))
 			break;
+		/*
+		 * The shared PD task can't wait here.  Report the mux as not
+		 * powered, so that its next use initializes it again.
+		 */
+		if (IS_ENABLED(CONFIG_USB_PD_SHARED_TASK))
+			return EC_ERROR_NOT_POWERED;
 		if (--tries <= 0)
 			return error ? error : EC_ERROR_TIMEOUT;
 		msleep(10);
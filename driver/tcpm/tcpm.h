@@ -24,7 +24,8 @@
 #ifndef CONFIG_USB_PD_TCPC
 
 /* I2C wrapper functions - get I2C port / slave addr from config struct. */
-#ifndef CONFIG_USB_PD_TCPC_LOW_POWER
+#if !defined(CONFIG_USB_PD_TCPC_LOW_POWER) && \
+	!defined(CONFIG_USB_PD_TCPC_REG_CACHE)
 static inline int tcpc_addr_write(int port, int i2c_addr, int reg, int val)
 {
 	return i2c_write8(tcpc_config[port].i2c_info.port,
@@ -98,7 +99,7 @@ static inline int tcpc_update16(int port, int reg,
 			    reg, mask, action);
 }
 
-#else /* !CONFIG_USB_PD_TCPC_LOW_POWER */
+#else /* !CONFIG_USB_PD_TCPC_LOW_POWER && !CONFIG_USB_PD_TCPC_REG_CACHE */
 int tcpc_addr_write(int port, int i2c_addr, int reg, int val);
 int tcpc_addr_write16(int port, int i2c_addr, int reg, int val);
 int tcpc_addr_read(int port, int i2c_addr, int reg, int *val);
@@ -115,7 +116,7 @@ int tcpc_update8(int port, int reg,
 int tcpc_update16(int port, int reg,
 		  uint16_t mask, enum mask_update_action action);
 
-#endif /* CONFIG_USB_PD_TCPC_LOW_POWER */
+#endif /* CONFIG_USB_PD_TCPC_LOW_POWER || CONFIG_USB_PD_TCPC_REG_CACHE */
 
 static inline int tcpc_write(int port, int reg, int val)
 {
@@ -38,6 +38,18 @@ struct accelgyro_drv {
 	 */
 	int (*read)(const struct motion_sensor_t *s, intv3_t v);
 
+	/**
+	 * Read several sensors of the same chip in one bus transaction,
+	 * for chips with their data in contiguous registers. Optional.
+	 * @s Pointer to the sensor the read is done for.
+	 * @group Mask of motion_sensors[] to read, including s. All use this
+	 * driver at the same port and address as s.
+	 * Stores the data in raw_xyz of each sensor in the group, and leaves
+	 * raw_xyz as it is for sensors without new data.
+	 * @return EC_SUCCESS if successful, non-zero if error.
+	 */
+	int (*read_group)(const struct motion_sensor_t *s, uint32_t group);
+
 	/**
 	 * Read the sensor's current internal temperature.
 	 *
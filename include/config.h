@@ -1320,6 +1320,7 @@
 #define CONFIG_CMD_PD
 #undef  CONFIG_CMD_PD_DEV_DUMP_INFO
 #undef  CONFIG_CMD_PD_FLASH
+#undef  CONFIG_CMD_PD_STATS
 #define CONFIG_CMD_PECI
 #undef  CONFIG_CMD_PLL
 #undef  CONFIG_CMD_PMU
@@ -1350,10 +1351,12 @@
 #define CONFIG_CMD_SYSLOCK
 #undef  CONFIG_CMD_TASK_RESET
 #undef  CONFIG_CMD_TASKREADY
+#undef  CONFIG_CMD_TCPC_ALERT_STATS
 #undef  CONFIG_CMD_TCPC_DUMP
 #define CONFIG_CMD_TEMP_SENSOR
 #define CONFIG_CMD_TIMERINFO
 #define CONFIG_CMD_TYPEC
+#undef  CONFIG_CMD_UART_STATS
 #undef  CONFIG_CMD_USART_INFO
 #define CONFIG_CMD_USBMUX
 #undef  CONFIG_CMD_USB_PD_CABLE
@@ -1478,6 +1481,13 @@
 /* Max length of a single line of input */
 #define CONFIG_CONSOLE_INPUT_LINE_SIZE 80
 
+/*
+ * Complete console command names with the TAB key.
+ *
+ * Boards may #define this if they have room for it.
+ */
+#undef CONFIG_CONSOLE_TAB_COMPLETION
+
 /* Enable verbose output to UART console and extra timestamp print precision. */
 #define CONFIG_CONSOLE_VERBOSE
 
@@ -2060,12 +2070,6 @@
 /* Config option to support 64-bit hostevents and wake-masks. */
 #define CONFIG_HOST_EVENT64
 
-/*
- * The host commands are sorted in the .rodata.hcmds section so use the binary
- * search algorithm to match a command to its handler
- */
-#undef CONFIG_HOSTCMD_SECTION_SORTED
-
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -2079,6 +2083,16 @@
  */
 #undef CONFIG_HOSTCMD_BATTERY_V2
 
+/* Support EC_CMD_BATCH, to run several host commands in one host packet. */
+#undef CONFIG_HOSTCMD_BATCH
+
+/*
+ * Keep per-command handler counts, timing and latency histograms, reported by
+ * EC_CMD_HOSTCMD_STATS and the hcstats console command.  Costs 44 bytes of
+ * RAM per host command.
+ */
+#undef CONFIG_HOSTCMD_STATS
+
 /* Default hcdebug mode, e.g. HCDEBUG_OFF or HCDEBUG_NORMAL */
 #define CONFIG_HOSTCMD_DEBUG_MODE HCDEBUG_NORMAL
 
@@ -2825,6 +2839,13 @@
 /* Provide rudimentary malloc/free like services for shared memory. */
 #undef CONFIG_MALLOC
 
+/*
+ * Use the segregated-fit allocator for CONFIG_MALLOC: free buffers are kept in
+ * power-of-two size class lists, so acquire and release take constant time
+ * instead of walking every free buffer.
+ */
+#undef CONFIG_MALLOC_SIZE_CLASSES
+
 /* Need for a math library */
 #undef CONFIG_MATH_UTIL
 
@@ -3828,6 +3849,31 @@
 #define CONFIG_USB_PRL_SM
 #define CONFIG_USB_PE_SM
 
+/*
+ * Run the TCPMv2 state machines of every port from the single PD_C0 task,
+ * instead of one PD_Cx task per port. Only ports with pending events or an
+ * expired deadline are run, and the stacks of the other PD tasks are saved.
+ * The board's task list must then only declare PD_C0.
+ *
+ * Events must be sent with pd_task_set_event() to reach a single port; events
+ * set on the task directly are delivered to all ports.
+ *
+ * Anything that blocks while one port is serviced stalls every port: msleep()
+ * or udelay() in TCPC, PPC, mux or board callbacks, and task_wait_event() in
+ * code run from the PD task, which also consumes the events of other ports
+ * unless it posts them again. The TCPCI driver reports a TCPC which is still
+ * booting instead of sleeping on it, but other drivers still wait inline, so
+ * only enable this with chips whose callbacks are quick.
+ */
+#undef CONFIG_USB_PD_SHARED_TASK
+
+/*
+ * Count the entries into each TCPMv2 TC and PE state and the time spent in
+ * it, and print them with "pd <port> state". Costs 16 bytes of RAM per state
+ * and port.
+ */
+#undef CONFIG_USB_PD_STATE_PROFILE
+
 /* Enables PD Console commands */
 #define CONFIG_USB_PD_CONSOLE_CMD
 
@@ -4012,6 +4058,13 @@
 /* Enable TCPC to enter low power mode */
 #undef CONFIG_USB_PD_TCPC_LOW_POWER
 
+/*
+ * Keep a shadow copy of the TCPCI registers only the TCPM writes (alert
+ * masks, ROLE_CTRL, POWER_CTRL, TCPC_CTRL, ...), so reads of them are answered
+ * locally and bit updates need a single I2C write instead of two transfers.
+ */
+#undef CONFIG_USB_PD_TCPC_REG_CACHE
+
 /*
  * Default debounce when exiting low-power mode before checking CC status.
  * Some TCPCs need additional time following a VBUS change to internally
@@ -4596,6 +4649,16 @@
 /* Support computing hash of code for verified boot */
 #undef CONFIG_VBOOT_HASH
 
+/*
+ * Number of regions to cache the SHA256 state for, so that rehashing after a
+ * flash write only rehashes from the first region written.  Costs 32 bytes
+ * of RAM per region.  With CONFIG_SAVE_VBOOT_HASH the cache is also kept
+ * across sysjump, which limits it to 8 regions.  Code which writes flash with
+ * flash_physical_write() or flash_physical_erase() must call
+ * vboot_hash_cache_invalidate() itself.
+ */
+#undef CONFIG_VBOOT_HASH_CACHE
+
 /* Support for secure temporary storage for verified boot */
 #undef CONFIG_VSTORE
 
@@ -4898,6 +4961,22 @@
 #endif
 #endif
 
+/*
+ * The shared PD task needs state machines which never block the task: the
+ * TCPMv2 ones, except for the (C)VPD device types, with an external TCPC.
+ */
+#ifdef CONFIG_USB_PD_SHARED_TASK
+#ifndef CONFIG_USB_PD_TCPMV2
+#error CONFIG_USB_PD_SHARED_TASK requires CONFIG_USB_PD_TCPMV2
+#endif
+#if defined(CONFIG_USB_VPD) || defined(CONFIG_USB_CTVPD)
+#error CONFIG_USB_PD_SHARED_TASK does not support VPD and CTVPD devices
+#endif
+#ifdef CONFIG_USB_PD_TCPC
+#error CONFIG_USB_PD_SHARED_TASK does not support CONFIG_USB_PD_TCPC
+#endif
+#endif
+
 /******************************************************************************/
 /*
  * Automatically define CONFIG_HOSTCMD_X86 if either child option is defined.
@@ -4999,6 +5078,7 @@
  */
 #ifdef CONFIG_EXPERIMENTAL_CONSOLE
 #undef CONFIG_CONSOLE_HISTORY
+#undef CONFIG_CONSOLE_TAB_COMPLETION
 #define CONFIG_CRC8
 #endif /* defined(CONFIG_EXPERIMENTAL_CONSOLE) */
 
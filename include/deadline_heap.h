@@ -0,0 +1,57 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Min-heap of IDs ordered by deadline.
+ */
+#ifndef __CROS_EC_DEADLINE_HEAP_H
+#define __CROS_EC_DEADLINE_HEAP_H
+
+#include "common.h"
+#include "timer.h"
+
+/*
+ * Binary min-heap of small IDs (such as task IDs), ordered by a deadline kept
+ * per ID, so the next one to expire is always at the root.  Inserting and
+ * removing an ID are O(log n).
+ *
+ * The heap does no locking; callers serialize access to it.
+ */
+struct deadline_heap {
+	/* Deadline of each ID; only change it while the ID isn't queued */
+	const timestamp_t *deadline;
+	/* Queued IDs in heap order */
+	uint8_t *heap;
+	/* Index of each ID in heap plus one, or 0 if the ID isn't queued */
+	uint8_t *pos;
+	/* Number of queued IDs */
+	int size;
+};
+
+/**
+ * Return non-zero if an ID is queued.
+ */
+static inline int deadline_heap_queued(const struct deadline_heap *h, int id)
+{
+	return h->pos[id] != 0;
+}
+
+/**
+ * Return the queued ID with the earliest deadline, or -1 if none is queued.
+ */
+static inline int deadline_heap_first(const struct deadline_heap *h)
+{
+	return h->size ? h->heap[0] : -1;
+}
+
+/**
+ * Queue an ID by its deadline.  The ID must not be queued already.
+ */
+void deadline_heap_insert(struct deadline_heap *h, int id);
+
+/**
+ * Remove a queued ID.
+ */
+void deadline_heap_remove(struct deadline_heap *h, int id);
+
+#endif /* __CROS_EC_DEADLINE_HEAP_H */
@@ -1016,7 +1016,7 @@ struct ec_host_response4 {
  * those are implementation-dependent and not defined here.
  *
  * All commands MUST be #defined to be 4-digit UPPER CASE hex values
- * (e.g., 0x00AB, not 0xab) for CONFIG_HOSTCMD_SECTION_SORTED to work.
+ * (e.g., 0x00AB, not 0xab) so the .rodata.hcmds sections sort by command.
  */
 
 /*****************************************************************************/
@@ -2469,6 +2469,8 @@ enum motionsense_command {
 
 	/*
 	 * Return a portion of the fifo.
+	 * From version 5, the entries are packed, see
+	 * struct ec_response_motion_sense_fifo_packed.
 	 */
 	MOTIONSENSE_CMD_FIFO_READ = 9,
 
@@ -2651,6 +2653,64 @@ struct ec_response_motion_sense_fifo_data {
 	struct ec_response_motion_sensor_data data[0];
 } __ec_todo_packed;
 
+/*
+ * Packed FIFO data, returned by MOTIONSENSE_CMD_FIFO_READ from version 5.
+ *
+ * number_data is the number of FIFO entries in the response, and data holds
+ * them back to back, packed. Each packed entry starts with a header byte:
+ * - bits 0-3: sensor number; MOTIONSENSE_FIFO_PACKED_SENSOR_NONE stands for
+ *   sensor number 0xff in timestamp entries.
+ * - bits 4-5: enum motionsense_fifo_packed_type.
+ * - bit 6: MOTIONSENSE_SENSOR_FLAG_TABLET_MODE.
+ * - bit 7: MOTIONSENSE_SENSOR_FLAG_WAKEUP.
+ *
+ * Numbers after the header are varints: 7 bits per byte, least significant
+ * group first, bit 7 set when more bytes follow. Signed numbers are zigzag
+ * encoded first (0, -1, 1, -2... become 0, 1, 2, 3...).
+ *
+ * Values are sent as differences with earlier values of the same response:
+ * at the start of each response, the previous timestamp and the previous
+ * data of all sensors are 0.
+ */
+enum motionsense_fifo_packed_type {
+	/*
+	 * Sensor data: the difference with the previous data of the same
+	 * sensor for each of the 3 axes, signed.
+	 */
+	MOTIONSENSE_FIFO_PACKED_DATA = 0,
+	/* Timestamp: the difference with the previous timestamp, signed. */
+	MOTIONSENSE_FIFO_PACKED_TIMESTAMP = 1,
+	/*
+	 * Any other entry: a struct ec_response_motion_sensor_data as is.
+	 * Header bits other than the type are 0.
+	 */
+	MOTIONSENSE_FIFO_PACKED_RAW = 2,
+	/*
+	 * Two entries, a timestamp of the sensor followed by sensor data; the
+	 * wake-up flag only applies to the data. The timestamp is sent as the
+	 * difference with its prediction, signed: the timestamp of the
+	 * previous sample entry of the sensor, plus the interval between the
+	 * two before it (0 if only one). For the first sample entry of the
+	 * sensor in the response, the prediction is the previous timestamp.
+	 * The data follows as for MOTIONSENSE_FIFO_PACKED_DATA.
+	 */
+	MOTIONSENSE_FIFO_PACKED_SAMPLE = 3,
+};
+
+#define MOTIONSENSE_FIFO_PACKED_SENSOR_MASK 0x0f
+#define MOTIONSENSE_FIFO_PACKED_SENSOR_NONE 0x0f
+#define MOTIONSENSE_FIFO_PACKED_TYPE_SHIFT 4
+#define MOTIONSENSE_FIFO_PACKED_TYPE_MASK (0x3 << 4)
+#define MOTIONSENSE_FIFO_PACKED_TABLET_MODE BIT(6)
+#define MOTIONSENSE_FIFO_PACKED_WAKEUP BIT(7)
+/* Largest packed entry: a header, a timestamp and 3 axes. */
+#define MOTIONSENSE_FIFO_PACKED_MAX_ENTRY (1 + 5 + 3 * 3)
+
+struct ec_response_motion_sense_fifo_packed {
+	uint32_t number_data;
+	uint8_t data[0];
+} __ec_todo_packed;
+
 /* List supported activity recognition */
 enum motionsensor_activity {
 	MOTIONSENSE_ACTIVITY_RESERVED = 0,
@@ -3024,6 +3084,8 @@ struct ec_response_motion_sense {
 
 		struct ec_response_motion_sense_fifo_data fifo_read;
 
+		struct ec_response_motion_sense_fifo_packed fifo_read_packed;
+
 		struct ec_response_online_calibration_data online_calib_read;
 
 		struct __ec_todo_packed {
@@ -6351,6 +6413,101 @@ struct ec_response_typec_discovery {
 	struct svid_mode_info svids[0];
 } __ec_align1;
 
+/*****************************************************************************/
+/*
+ * Run several host commands in one host packet.
+ *
+ * The params are a struct ec_params_batch followed by `count` sub-requests.
+ * Each sub-request is a struct ec_batch_request followed by data_len bytes of
+ * params for that command, padded with zeros to a multiple of 4 bytes.
+ *
+ * The response is a struct ec_response_batch followed by one sub-response per
+ * sub-request that was run.  Each sub-response is a struct ec_batch_response
+ * followed by data_len bytes of response data, also padded to a multiple of
+ * 4 bytes.  A sub-command which fails has no response data.
+ *
+ * Sub-commands run in order, and get whatever room is left in the response
+ * packet.  Running stops early when the response packet is full, or at the
+ * first failed sub-command if EC_BATCH_FLAG_STOP_ON_ERROR is set.
+ *
+ * Sub-commands must complete synchronously.  EC_CMD_BATCH itself,
+ * EC_CMD_REBOOT_EC and EC_CMD_FLASH_ERASE fail with EC_RES_INVALID_COMMAND,
+ * as does any sub-command which returns EC_RES_IN_PROGRESS or sends its
+ * response before finishing.
+ */
+#define EC_CMD_BATCH 0x0132
+
+/* Stop at the first sub-command which doesn't return EC_RES_SUCCESS */
+#define EC_BATCH_FLAG_STOP_ON_ERROR BIT(0)
+
+struct ec_params_batch {
+	uint8_t count;		/* Number of sub-requests */
+	uint8_t flags;		/* EC_BATCH_FLAG_* */
+	uint16_t reserved;
+} __ec_align4;
+
+struct ec_batch_request {
+	uint16_t command;
+	uint8_t command_version;
+	uint8_t reserved;
+	uint16_t data_len;	/* Params size, before padding */
+	uint16_t reserved2;
+} __ec_align4;
+
+struct ec_response_batch {
+	uint8_t count;		/* Number of sub-responses */
+	uint8_t reserved[3];
+} __ec_align4;
+
+struct ec_batch_response {
+	uint16_t result;	/* enum ec_status */
+	uint16_t data_len;	/* Response size, before padding */
+} __ec_align4;
+
+/*****************************************************************************/
+/*
+ * Get host command handler statistics.
+ *
+ * The EC keeps an invocation count, total and maximum handler time, and a
+ * latency histogram for every host command it implements.  Commands are
+ * reported in the EC's table order, starting at the index in the params; as
+ * many entries as fit are returned, skipping commands which have never run.
+ * next_index is the index to ask for to continue, or 0 when the whole table
+ * has been reported.
+ *
+ * Histogram bucket 0 counts calls which took less than 2 us, bucket n counts
+ * calls which took [2^n, 2^(n+1)) us, and the last bucket also counts
+ * everything slower.  Bucket counts saturate at 0xffff.
+ */
+#define EC_CMD_HOSTCMD_STATS 0x0133
+
+/* Clear all statistics before reporting */
+#define EC_HOSTCMD_STATS_FLAG_RESET BIT(0)
+
+#define EC_HOSTCMD_STATS_BUCKETS 16
+
+struct ec_params_hostcmd_stats {
+	uint16_t index;		/* First table entry to report */
+	uint8_t flags;		/* EC_HOSTCMD_STATS_FLAG_* */
+	uint8_t reserved;
+} __ec_align2;
+
+struct ec_hostcmd_stats_entry {
+	uint16_t command;
+	uint16_t reserved;
+	uint32_t count;		/* Number of calls */
+	uint32_t total_us;	/* Total time spent in the handler */
+	uint32_t max_us;	/* Slowest call */
+	uint16_t histogram[EC_HOSTCMD_STATS_BUCKETS];
+} __ec_align4;
+
+struct ec_response_hostcmd_stats {
+	uint16_t next_index;	/* Index to continue from, 0 when done */
+	uint8_t count;		/* Number of entries */
+	uint8_t reserved;
+	struct ec_hostcmd_stats_entry entries[0];
+} __ec_align4;
+
 /*****************************************************************************/
 /* The command range 0x200-0x2FF is reserved for Rotor. */
 
@@ -6760,7 +6917,7 @@ struct ec_params_charger_control {
  * their EC commands for easier development, testing, debugging, and support.
  *
  * All commands MUST be #defined to be 4-digit UPPER CASE hex values
- * (e.g., 0x00AB, not 0xab) for CONFIG_HOSTCMD_SECTION_SORTED to work.
+ * (e.g., 0x00AB, not 0xab) so the .rodata.hcmds sections sort by command.
  *
  * In your experimental code, you may want to do something like this:
  *
@@ -244,6 +244,15 @@ struct hook_data {
 	int priority;
 };
 
+/**
+ * Sort the hook routines of each type by priority.
+ *
+ * Called once from main(), before interrupts or tasks are enabled and before
+ * anything may call hook_notify(); some chips notify HOOK_FREQ_CHANGE from
+ * clock_init().
+ */
+void hook_init(void);
+
 /**
  * Call all the hook routines of a specified type.
  *
@@ -12,6 +12,15 @@
 #include "ec_commands.h"
 enum power_state;
 
+/* One segment of response data which lives outside the response buffer */
+struct host_response_iov {
+	const void *data;
+	uint16_t size;
+};
+
+/* Max data segments a handler may hand back in one response */
+#define HOST_RESPONSE_IOV_MAX 3
+
 /* Args for host command handler */
 struct host_cmd_handler_args {
 	/*
@@ -41,6 +50,17 @@ struct host_cmd_handler_args {
 	 */
 	uint16_t response_size;
 
+	/*
+	 * Response data segments, for handlers which return large data that
+	 * already sits in memory (a frame buffer, mapped flash, ...).  If
+	 * response_iov_count is non-zero, the response is these segments in
+	 * order instead of the response buffer, and response_size is their
+	 * total size.  The data must stay valid until the response is sent.
+	 * Set these up with host_response_add_iov().
+	 */
+	struct host_response_iov response_iov[HOST_RESPONSE_IOV_MAX];
+	uint8_t response_iov_count;
+
 	/*
 	 * This is the result returned by command and therefore the status to
 	 * be reported from the command execution to the host. The driver
@@ -102,6 +122,24 @@ struct host_packet {
 	/* Size of output response data, in bytes */
 	uint16_t response_size;
 
+	/*
+	 * Set by drivers which can send response data segments straight from
+	 * response_iov.  When a handler returns segments, the response buffer
+	 * then only holds the struct ec_host_response header, and the data
+	 * follows from response_iov.  Other drivers get the data copied in
+	 * behind the header as usual.
+	 *
+	 * Only the stm32f0 I2C slave sets this, since it feeds the response a
+	 * byte at a time from its TX interrupt.  The stm32 SPI slave sends the
+	 * response as a single DMA transfer which the AP clocks out without a
+	 * pause, and its DMA can't chain buffers of different sizes.  LPC and
+	 * eSPI hosts read the response from the shared window.  Host tests
+	 * call host_command_process(), which gathers the segments.
+	 */
+	uint8_t response_iov_ok;
+	const struct host_response_iov *response_iov;
+	uint8_t response_iov_count;
+
 	/*
 	 * Error from driver; if this is non-zero, host command handler will
 	 * return a properly formatted error response packet rather than
@@ -128,6 +166,17 @@ struct host_command {
 	int version_mask;
 };
 
+/*
+ * Statistics for one host command, kept in a table parallel to __hcmds when
+ * CONFIG_HOSTCMD_STATS is defined.  See EC_CMD_HOSTCMD_STATS.
+ */
+struct host_command_stats {
+	uint32_t count;
+	uint32_t total_us;
+	uint32_t max_us;
+	uint16_t histogram[EC_HOSTCMD_STATS_BUCKETS];
+};
+
 #ifdef CONFIG_HOST_EVENT64
 typedef uint64_t host_event_t;
 #define HOST_EVENT_CPRINTS(str, e)	CPRINTS("%s 0x%016" PRIx64, str, e)
@@ -212,6 +261,28 @@ int get_lazy_wake_mask(enum power_state state, host_event_t *mask);
 uint8_t lpc_is_active_wm_set_by_host(void);
 #endif
 
+/**
+ * Append a segment of response data which is sent from where it is.
+ *
+ * Use instead of copying large data into args->response.  The caller must
+ * have checked that the total fits in args->response_max.
+ *
+ * @param args	Command handler args
+ * @param data	Response data; must stay valid until the response is sent
+ * @param size	Size of data in bytes
+ */
+void host_response_add_iov(struct host_cmd_handler_args *args,
+			   const void *data, int size);
+
+/**
+ * Copy response data segments into the response buffer.
+ *
+ * For drivers and callers which need the whole response in args->response.
+ *
+ * @param args	Command handler args
+ */
+void host_response_gather_iov(struct host_cmd_handler_args *args);
+
 /**
  * Send a response to the relevant driver for transmission
  *
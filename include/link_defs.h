@@ -77,12 +77,22 @@ extern const struct hook_data __hooks_usb_pd_disconnect_end[];
 extern const struct hook_data __hooks_usb_pd_connect[];
 extern const struct hook_data __hooks_usb_pd_connect_end[];
 
+/* Hook data pointers sorted by priority, one per hook data entry */
+extern const struct hook_data *__hooks_sorted[];
+extern const struct hook_data *__hooks_sorted_end[];
+
 /* Deferrable functions and firing times*/
 extern const struct deferred_data __deferred_funcs[];
 extern const struct deferred_data __deferred_funcs_end[];
 extern uint64_t __deferred_until[];
 extern uint64_t __deferred_until_end[];
 
+/* Deferred call queue: changed-function bitmap and pending list links */
+extern uint32_t __deferred_changed[];
+extern uint32_t __deferred_changed_end[];
+extern uint16_t __deferred_next[];
+extern uint16_t __deferred_next_end[];
+
 /* I2C fake devices for unit testing */
 extern const struct test_i2c_xfer __test_i2c_xfer[];
 extern const struct test_i2c_xfer __test_i2c_xfer_end[];
@@ -91,6 +101,14 @@ extern const struct test_i2c_xfer __test_i2c_xfer_end[];
 extern const struct host_command __hcmds[];
 extern const struct host_command __hcmds_end[];
 
+/* Host command lookup table, two slots per host command */
+extern uint8_t __hcmds_index[];
+extern uint8_t __hcmds_index_end[];
+
+/* Host command statistics, one per host command */
+extern struct host_command_stats __hcmds_stats[];
+extern struct host_command_stats __hcmds_stats_end[];
+
 /* MKBP events */
 extern const struct mkbp_event_source __mkbp_evt_srcs[];
 extern const struct mkbp_event_source __mkbp_evt_srcs_end[];
@@ -102,6 +102,19 @@ int motion_sense_fifo_over_thres(void);
 int motion_sense_fifo_read(int capacity_bytes, int max_count, void *out,
 			   uint16_t *out_size);
 
+/**
+ * Read available committed entries from the fifo, packed as described for
+ * struct ec_response_motion_sense_fifo_packed.
+ *
+ * @param capacity_bytes The number of bytes available to be written to `out`.
+ * @param max_count The maximum number of entries to be placed in `out`.
+ * @param out The target to write the packed entries into.
+ * @param out_size The number of bytes written to `out`.
+ * @return The number of entries written to `out`.
+ */
+int motion_sense_fifo_read_packed(int capacity_bytes, int max_count,
+				  void *out, uint16_t *out_size);
+
 /**
  * Reset the internal data structures of the motion sense fifo.
  */
@@ -76,6 +76,27 @@
 __stdlib_compat int vfnprintf(int (*addchar)(void *context, int c),
 			      void *context, const char *format, va_list args);
 
+/**
+ * Print formatted output to a function, like vfnprintf(), passing runs of
+ * characters to addstr() when possible.
+ *
+ * @param addchar	Function to be called for single characters, as for
+ *			vfnprintf().
+ * @param addstr	Function to be called to add several characters at
+ *			once, or NULL to only use addchar(). Will be passed the
+ *			same context passed to vfnprintf_str(), the characters
+ *			and their number. Should add as many of them as it can
+ *			and return 0 if all were accepted, or non-zero if some
+ *			were dropped due to overflow.
+ * @param context	Context pointer to pass to addchar() and addstr()
+ * @param format	Format string (see above for acceptable formats)
+ * @param args		Parameters
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the output was truncated.
+ */
+int vfnprintf_str(int (*addchar)(void *context, int c),
+		  int (*addstr)(void *context, const char *str, int len),
+		  void *context, const char *format, va_list args);
+
 /**
  * Print formatted outut to a string.
  *
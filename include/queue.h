@@ -67,6 +67,24 @@ struct queue_state {
 	size_t tail; /* tail: next to enqueue */
 };
 
+/*
+ * Concurrency: a queue is single producer, single consumer.  The producer
+ * (queue_add_*, queue_get_write_chunk(s), queue_advance_tail) only ever writes
+ * tail, and the consumer (queue_remove_*, queue_peek_*, queue_get_read_chunk(s),
+ * queue_advance_head and the iterators) only ever writes head.  Each side
+ * reads the other side's index with acquire semantics and publishes its own
+ * with release semantics, so the producer and consumer may run in different
+ * contexts (ISR and task, or task and DMA completion) without any locking:
+ *
+ *  - units written before queue_advance_tail() are visible to a consumer that
+ *    sees the new tail, and
+ *  - units read before queue_advance_head() are not overwritten by a producer
+ *    that sees the new head.
+ *
+ * More than one producer or more than one consumer still needs an external
+ * lock.  queue_init() must not race with either side.
+ */
+
 /*
  * Queue configuration stored in flash.
  */
@@ -184,6 +202,35 @@ struct queue_chunk queue_get_write_chunk(struct queue const *q, size_t offset);
  */
 struct queue_chunk queue_get_read_chunk(struct queue const *q);
 
+/*
+ * Return all of the free space after the tail of the queue as at most two
+ * contiguous chunks: chunks[0] starts at the tail and chunks[1] holds the part
+ * that wraps around to the start of the buffer (count 0 if there is none).
+ * This lets a bulk producer, such as a DMA engine with a two entry descriptor
+ * chain, fill the whole free space without calling queue_get_write_chunk once
+ * per wrap.  Call queue_advance_tail with the total number of units written.
+ *
+ * @param q	Queue to query
+ * @param chunks	Array of two chunks to fill in
+ * @return Total number of free units described by the chunks
+ */
+size_t queue_get_write_chunks(struct queue const *q,
+			      struct queue_chunk chunks[2]);
+
+/*
+ * Return all of the units in the queue as at most two contiguous chunks:
+ * chunks[0] starts at the head and chunks[1] holds the part that wraps around
+ * to the start of the buffer.  An unused chunk has a count of 0 and a NULL
+ * buffer.  The same rules as for queue_get_read_chunk apply; call
+ * queue_advance_head with the total number of units consumed.
+ *
+ * @param q	Queue to query
+ * @param chunks	Array of two chunks to fill in
+ * @return Total number of units described by the chunks
+ */
+size_t queue_get_read_chunks(struct queue const *q,
+			     struct queue_chunk chunks[2]);
+
 /*
  * Move the queue head pointer forward count units.  This discards count
  * elements from the head of the queue.  It will only discard up to the total
@@ -63,6 +63,22 @@ int rsa_verify(const struct rsa_public_key *key,
 	       const uint8_t *sha,
 	       uint32_t *workbuf32);
 
+/**
+ * Verify several SHA256WithRSA signatures made with the same key, such as the
+ * signatures of a set of images.
+ *
+ * @param key		RSA public key
+ * @param count		Number of signatures, at most 32
+ * @param signatures	Array of count RSA signatures
+ * @param shas		Array of count SHA-256 digests to check them against
+ * @param workbuf32	Work buffer; caller must verify this is
+ *			3 x RSANUMWORDS elements long.
+ * @return Bitmap with bit i set if signatures[i] verified.
+ */
+uint32_t rsa_verify_batch(const struct rsa_public_key *key, int count,
+			  const uint8_t * const *signatures,
+			  const uint8_t * const *shas, uint32_t *workbuf32);
+
 #endif /* !__ASSEMBLER__ */
 
 #endif /* __CROS_EC_RSA_H */
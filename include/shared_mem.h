@@ -67,6 +67,15 @@ struct shm_buffer {
 	size_t buffer_size;
 };
 
+#if defined(TEST_BUILD) && defined(CONFIG_MALLOC_SIZE_CLASSES)
+/**
+ * Check the internal consistency of the allocator.
+ *
+ * @return EC_SUCCESS if all is well, EC_ERROR_UNKNOWN otherwise
+ */
+int shared_mem_check(void);
+#endif
+
 #ifdef TEST_SHMALLOC
 
 /*
@@ -138,6 +138,22 @@ int uart_tx_dma_ready(void);
  */
 void uart_tx_dma_start(const char *src, int len);
 
+/**
+ * Start a UART transmit DMA transfer of two spans, one after the other
+ *
+ * Used when the transmit buffer wraps.  A chip which can queue the second
+ * span starts it as soon as the first is sent, and only reports
+ * uart_tx_dma_ready() once both are.  The default sends the first span only.
+ *
+ * @param src		Pointer to first span to send
+ * @param len		Length of first span in bytes
+ * @param next		Pointer to second span to send
+ * @param next_len	Length of second span in bytes, may be 0
+ * @return Number of bytes which will be sent
+ */
+__override_proto int uart_tx_dma_start_spans(const char *src, int len,
+					     const char *next, int next_len);
+
 /**
  * Return non-zero if the UART has a character available to read.
  */
@@ -23,8 +23,16 @@
  * Define PD_PORT_TO_TASK_ID() and TASK_ID_TO_PD_PORT() macros to
  * go between PD port number and task ID. Assume that TASK_ID_PD_C0 is the
  * lowest task ID and IDs are on a continuous range.
+ *
+ * With CONFIG_USB_PD_SHARED_TASK, the PD_C0 task services every port, so the
+ * port for that task is the one it is servicing at the moment.
  */
-#if defined(HAS_TASK_PD_C0) && defined(CONFIG_USB_PD_PORT_MAX_COUNT)
+#if defined(HAS_TASK_PD_C0) && defined(CONFIG_USB_PD_PORT_MAX_COUNT) && \
+	defined(CONFIG_USB_PD_SHARED_TASK)
+#define PD_PORT_TO_TASK_ID(port) TASK_ID_PD_C0
+#define TASK_ID_TO_PD_PORT(id) \
+	((id) == TASK_ID_PD_C0 ? pd_task_get_port() : -1)
+#elif defined(HAS_TASK_PD_C0) && defined(CONFIG_USB_PD_PORT_MAX_COUNT)
 #define PD_PORT_TO_TASK_ID(port) (TASK_ID_PD_C0 + (port))
 #define TASK_ID_TO_PD_PORT(id) ((id) - TASK_ID_PD_C0)
 #else
@@ -64,8 +72,32 @@ enum pd_rx_errors {
 #define PD_EVENT_SYSJUMP		TASK_EVENT_CUSTOM_BIT(10)
 /* Receive a Hard Reset. */
 #define PD_EVENT_RX_HARD_RESET		TASK_EVENT_CUSTOM_BIT(11)
+/* Shared PD task: a port has events pending in its own event bitmap */
+#define PD_EVENT_PORT_PENDING		TASK_EVENT_CUSTOM_BIT(12)
 /* First free event on PD task */
-#define PD_EVENT_FIRST_FREE_BIT		12
+#define PD_EVENT_FIRST_FREE_BIT		13
+
+#ifdef CONFIG_USB_PD_SHARED_TASK
+/**
+ * Set events for a port of the shared PD task.
+ *
+ * The events are held for the port until the task services it, so that only
+ * ports with work are run. Events set on the task directly, as
+ * task_set_event() does, are delivered to every port.
+ *
+ * @param port USB-C port number
+ * @param event Events to set (PD_EVENT_* or TASK_EVENT_WAKE)
+ */
+void pd_task_set_event(int port, uint32_t event);
+
+/**
+ * Return the port the shared PD task is servicing.
+ */
+int pd_task_get_port(void);
+#else
+#define pd_task_set_event(port, event) \
+	task_set_event(PD_PORT_TO_TASK_ID(port), (event), 0)
+#endif
 
 /* Ensure TCPC is out of low power mode before handling these events. */
 #define PD_EXIT_LOW_POWER_EVENT_MASK \
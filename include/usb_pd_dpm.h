@@ -63,4 +63,12 @@ void dpm_vdm_naked(int port, enum tcpm_transmit_type type, uint16_t svid,
  */
 void dpm_run(int port);
 
+/*
+ * Returns true if dpm_run() has a mode entry or exit step to take now, so
+ * the Policy Engine must keep calling it.
+ *
+ * @param port USB-C port number
+ */
+bool dpm_has_work(int port);
+
 #endif  /* __CROS_EC_USB_DPM_H */
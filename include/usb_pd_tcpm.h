@@ -468,12 +468,20 @@ struct tcpm_drv {
  * Bit 3 --> Set to 1 if TCPC is using TCPCI Revision 2.0
  * Bit 4 --> Set to 1 if TCPC is using TCPCI Revision 2.0 but does not support
  *           the vSafe0V bit in the EXTENDED_STATUS_REGISTER
+ * Bit 5 --> Set to 1 if TCPC auto-increments the register address on reads.
+ *           Alert handling still reads ALERT alone, then block-reads
+ *           FAULT_STATUS..ALERT_EXTENDED when a fault or extended alert is
+ *           pending, then ALERT_MASK..EXTENDED_STATUS on a status change or
+ *           just the mask registers otherwise. TCPCI Rev 1.0 ports also read
+ *           RX_BYTE_CNT..RX_HDR in one go; Rev 2.0 RX is unchanged. No board
+ *           sets this yet.
  */
 #define TCPC_FLAGS_ALERT_ACTIVE_HIGH	BIT(0)
 #define TCPC_FLAGS_ALERT_OD		BIT(1)
 #define TCPC_FLAGS_RESET_ACTIVE_HIGH	BIT(2)
 #define TCPC_FLAGS_TCPCI_REV2_0		BIT(3)
 #define TCPC_FLAGS_TCPCI_REV2_0_NO_VSAFE0V	BIT(4)
+#define TCPC_FLAGS_BLOCK_READ		BIT(5)
 
 struct tcpc_config_t {
 	enum ec_bus_type bus_type;	/* enum ec_bus_type */
@@ -129,6 +129,14 @@ enum pe_states pe_get_state_id(int port);
  */
 int pe_is_running(int port);
 
+/**
+ * Returns when the Policy Engine next needs to run, absent any event.
+ *
+ * @param port USB-C port number
+ * @return Absolute time, USBC_WAKEUP_POLL or USBC_WAKEUP_NONE
+ */
+__override_proto uint64_t pe_get_next_wakeup(int port);
+
 /**
  * Informs the Policy Engine that the Power Supply is at it's default state
  *
@@ -203,5 +211,13 @@ const char *pe_get_current_state(int port);
  */
 uint32_t pe_get_flags(int port);
 
+/**
+ * Print how often each PE state was entered and the time spent in it
+ * (CONFIG_USB_PD_STATE_PROFILE)
+ *
+ * @param port USB-C port number
+ */
+void pe_print_state_profile(int port);
+
 #endif /* __CROS_EC_USB_PE_H */
 
@@ -21,6 +21,14 @@
  */
 int prl_is_running(int port);
 
+/**
+ * Returns when the Protocol Layer next needs to run, absent any event.
+ *
+ * @param port USB-C port number
+ * @return Absolute time, USBC_WAKEUP_POLL or USBC_WAKEUP_NONE
+ */
+__override_proto uint64_t prl_get_next_wakeup(int port);
+
 /**
  * Returns true if the Protocol Layer State Machine is in the
  * process of transmitting or receiving chunked messages.
@@ -105,6 +105,62 @@ struct test_sm_data {
 };
 #endif
 
+/*
+ * Values returned by the state machines' *_get_next_wakeup() functions, which
+ * tell the PD task how long it may sleep before running them again.
+ */
+/* The state machine is busy and needs running at the regular poll interval */
+#define USBC_WAKEUP_POLL 0
+/* The state machine only needs to run when an event arrives */
+#define USBC_WAKEUP_NONE UINT64_MAX
+
+/**
+ * Lower a wakeup time to a timer deadline, if the timer has not expired yet.
+ *
+ * @param wakeup    Earliest wakeup time found so far
+ * @param now       Current time
+ * @param deadline  Timer deadline (TIMER_DISABLED never lowers the wakeup)
+ */
+static inline void usbc_wakeup_at(uint64_t *wakeup, uint64_t now,
+				  uint64_t deadline)
+{
+	if (deadline >= now && deadline < *wakeup)
+		*wakeup = deadline;
+}
+
+#ifdef CONFIG_USB_PD_STATE_PROFILE
+/* How often a state was entered and how long it was the current state */
+struct sm_state_profile {
+	uint32_t entries;
+	uint64_t time_us;
+};
+
+/**
+ * Account a state transition in the profile of a state machine.
+ *
+ * @param profile Profile of each state, indexed like the state table
+ * @param since   When the current state was entered; updated to now
+ * @param from    Index of the state being left, or -1 if there is none
+ * @param to      Index of the state being entered
+ */
+void sm_profile_transition(struct sm_state_profile *profile, uint64_t *since,
+			   int from, int to);
+
+/**
+ * Print the profile of the states which have been entered.
+ *
+ * @param sm      State machine name
+ * @param profile Profile of each state, indexed like the state table
+ * @param count   Number of states in the table
+ * @param names   State names, or NULL to print state indexes
+ * @param current Index of the current state, or -1 if there is none
+ * @param since   When the current state was entered
+ */
+void sm_profile_print(const char *sm, const struct sm_state_profile *profile,
+		      int count, const char * const *names, int current,
+		      uint64_t since);
+#endif
+
 /* Creates a state machine state that will never link. Useful with IS_ENABLED */
 #define GEN_NOT_SUPPORTED(state) extern typeof(state) state ## _NOT_SUPPORTED
 
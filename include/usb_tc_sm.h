@@ -76,6 +76,14 @@ uint8_t tc_get_polarity(int port);
  */
 uint8_t tc_get_pd_enabled(int port);
 
+/**
+ * Returns when the Type-C state machine next needs to run, absent any event.
+ *
+ * @param port USB-C port number
+ * @return Absolute time, USBC_WAKEUP_POLL or USBC_WAKEUP_NONE
+ */
+__override_proto uint64_t tc_get_next_wakeup(int port);
+
 /**
  * Set the power role
  *
@@ -365,6 +373,14 @@ const char *tc_get_current_state(int port);
  */
 uint32_t tc_get_flags(int port);
 
+/**
+ * Print how often each typeC state was entered and the time spent in it
+ * (CONFIG_USB_PD_STATE_PROFILE)
+ *
+ * @param port USB-C port number
+ */
+void tc_print_state_profile(int port);
+
 #ifdef CONFIG_USB_CTVPD
 
 /**
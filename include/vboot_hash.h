@@ -37,6 +37,24 @@ int vboot_get_rw_hash(const uint8_t **dst);
  */
 int vboot_hash_invalidate(int offset, int size);
 
+/**
+ * Drop the cached hash states for data at and after the specified region.
+ *
+ * Must be called for every flash write or erase, even when the hash itself
+ * is kept, so that a later hash of the same data doesn't resume from stale
+ * states.  flash_write() and flash_erase() do this; callers of
+ * flash_physical_write() and flash_physical_erase() must do it themselves.
+ * See CONFIG_VBOOT_HASH_CACHE.
+ *
+ * @param offset	Region start offset in flash
+ * @param size		Size of region in bytes
+ */
+#ifdef CONFIG_VBOOT_HASH_CACHE
+void vboot_hash_cache_invalidate(int offset, int size);
+#else
+static inline void vboot_hash_cache_invalidate(int offset, int size) { }
+#endif
+
 /**
  * Get vboot progress status.
  *
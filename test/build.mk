@@ -27,6 +27,7 @@ test-list-host += charge_ramp
 test-list-host += compile_time_macros
 test-list-host += console_edit
 test-list-host += crc32
+test-list-host += deadline_heap
 test-list-host += entropy
 test-list-host += extpwr_gpio
 test-list-host += fan
@@ -70,17 +71,20 @@ test-list-host += sbs_charging_v2
 test-list-host += sha256
 test-list-host += sha256_unrolled
 test-list-host += shmalloc
+test-list-host += shmalloc_classes
 test-list-host += static_if
 test-list-host += static_if_error
 test-list-host += system
 test-list-host += thermal
 test-list-host += timer_dos
+test-list-host += uart_stats
 test-list-host += uptime
 test-list-host += usb_common
 test-list-host += usb_pd_int
 test-list-host += usb_pd
 test-list-host += usb_pd_giveback
 test-list-host += usb_pd_rev30
+test-list-host += usb_pd_shared_task
 test-list-host += usb_ppc
 test-list-host += usb_sm_framework_h3
 test-list-host += usb_sm_framework_h2
@@ -89,17 +93,21 @@ test-list-host += usb_sm_framework_h0
 test-list-host += usb_typec_vpd
 test-list-host += usb_typec_ctvpd
 test-list-host += usb_typec_drp_acc_trysrc
+test-list-host += usb_typec_drp_acc_trysrc_shared
 test-list-host += usb_prl_old
 test-list-host += usb_tcpmv2_tcpci
+test-list-host += usb_tcpmv2_tcpci_block_read
 test-list-host += usb_prl
 test-list-host += usb_prl_noextended
 test-list-host += usb_pe_drp_old
 test-list-host += usb_pe_drp_old_noextended
 test-list-host += usb_pe_drp
 test-list-host += usb_pe_drp_noextended
+test-list-host += usb_pe_drp_shared
 test-list-host += utils
 test-list-host += utils_str
 test-list-host += vboot
+test-list-host += vboot_hash
 test-list-host += x25519
 test-list-host += stillness_detector
 endif
@@ -135,6 +143,7 @@ charge_ramp-y+=charge_ramp.o
 compile_time_macros-y=compile_time_macros.o
 console_edit-y=console_edit.o
 crc32-y=crc32.o
+deadline_heap-y=deadline_heap.o
 entropy-y=entropy.o
 extpwr_gpio-y=extpwr_gpio.o
 fan-y=fan.o
@@ -161,7 +170,9 @@ math_util-y=math_util.o
 motion_angle-y=motion_angle.o motion_angle_data_literals.o motion_common.o
 motion_angle_tablet-y=motion_angle_tablet.o motion_angle_data_literals_tablet.o motion_common.o
 motion_lid-y=motion_lid.o
-motion_sense_fifo-y=motion_sense_fifo.o
+# Round trip through the packed fifo format decoder used by ectool.
+motion_sense_fifo-y=motion_sense_fifo.o ../util/ec_motion_fifo.o
+dirs-y+=util
 online_calibration-y=online_calibration.o
 kasa-y=kasa.o
 mpu-y=mpu.o
@@ -183,6 +194,7 @@ sbs_charging_v2-y=sbs_charging_v2.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
 shmalloc-y=shmalloc.o
+shmalloc_classes-y=shmalloc.o
 static_if-y=static_if.o
 stm32f_rtc-y=stm32f_rtc.o
 stress-y=stress.o
@@ -190,12 +202,14 @@ system-y=system.o
 thermal-y=thermal.o
 timer_calib-y=timer_calib.o
 timer_dos-y=timer_dos.o
+uart_stats-y=uart_stats.o
 uptime-y=uptime.o
 usb_common-y=usb_common_test.o fake_battery.o
 usb_pd_int-y=usb_pd_int.o
 usb_pd-y=usb_pd.o
 usb_pd_giveback-y=usb_pd.o
 usb_pd_rev30-y=usb_pd.o
+usb_pd_shared_task-y=usb_pd_shared_task.o vpd_api.o
 usb_ppc-y=usb_ppc.o
 usb_sm_framework_h3-y=usb_sm_framework_h3.o
 usb_sm_framework_h2-y=usb_sm_framework_h3.o
@@ -205,6 +219,8 @@ usb_typec_vpd-y=usb_typec_ctvpd.o vpd_api.o usb_sm_checks.o fake_usbc.o
 usb_typec_ctvpd-y=usb_typec_ctvpd.o vpd_api.o usb_sm_checks.o fake_usbc.o
 usb_typec_drp_acc_trysrc-y=usb_typec_drp_acc_trysrc.o vpd_api.o \
 	usb_sm_checks.o
+usb_typec_drp_acc_trysrc_shared-y=usb_typec_drp_acc_trysrc.o vpd_api.o \
+	usb_sm_checks.o
 usb_prl_old-y=usb_prl_old.o usb_sm_checks.o fake_usbc.o
 usb_prl-y=usb_prl.o usb_sm_checks.o
 usb_prl_noextended-y=usb_prl_noextended.o usb_sm_checks.o fake_usbc.o
@@ -212,10 +228,13 @@ usb_pe_drp_old-y=usb_pe_drp_old.o usb_sm_checks.o fake_usbc.o
 usb_pe_drp_old_noextended-y=usb_pe_drp_old.o usb_sm_checks.o fake_usbc.o
 usb_pe_drp-y=usb_pe_drp.o usb_sm_checks.o
 usb_pe_drp_noextended-y=usb_pe_drp_noextended.o usb_sm_checks.o
+usb_pe_drp_shared-y=usb_pe_drp.o usb_sm_checks.o
 usb_tcpmv2_tcpci-y=usb_tcpmv2_tcpci.o vpd_api.o usb_sm_checks.o
+usb_tcpmv2_tcpci_block_read-y=usb_tcpmv2_tcpci.o vpd_api.o usb_sm_checks.o
 utils-y=utils.o
 utils_str-y=utils_str.o
 vboot-y=vboot.o
+vboot_hash-y=vboot_hash.o
 float-y=fp.o
 fp-y=fp.o
 x25519-y=x25519.o
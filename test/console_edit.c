@@ -28,6 +28,15 @@ static int command_test_2(int argc, char **argv)
 }
 DECLARE_CONSOLE_COMMAND(test2, command_test_2, NULL, NULL);
 
+static int cmd_3_call_cnt;
+
+static int command_test_3(int argc, char **argv)
+{
+	cmd_3_call_cnt++;
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(tabcomplete, command_test_3, NULL, NULL);
+
 /*****************************************************************************/
 /* Test utilities */
 
@@ -273,6 +282,52 @@ static int test_output_channel(void)
 	return EC_SUCCESS;
 }
 
+static int test_prefix_match(void)
+{
+	cmd_1_call_cnt = 0;
+	cmd_2_call_cnt = 0;
+	cmd_3_call_cnt = 0;
+	UART_INJECT("tabc\n");
+	msleep(30);
+	UART_INJECT("TEST2\n");
+	msleep(30);
+	/* Ambiguous between test1 and test2 */
+	UART_INJECT("tes\n");
+	msleep(30);
+	TEST_CHECK(cmd_1_call_cnt == 0 && cmd_2_call_cnt == 1 &&
+		   cmd_3_call_cnt == 1);
+}
+
+static int test_tab_complete(void)
+{
+	cmd_1_call_cnt = 0;
+	cmd_3_call_cnt = 0;
+	UART_INJECT("tabc\t\n");
+	msleep(30);
+	/* Completes to the shared "test", then the user picks test1 */
+	UART_INJECT("te\t1\n");
+	msleep(30);
+	TEST_CHECK(cmd_1_call_cnt == 1 && cmd_3_call_cnt == 1);
+}
+
+static int test_tab_list(void)
+{
+	const char *exp_output = "test\n"
+				 " test1 test2\n"
+				 "> test";
+
+	test_capture_console(1);
+	UART_INJECT("test\t");
+	msleep(30);
+	test_capture_console(0);
+	home_key();
+	ctrl_key('K');
+	TEST_ASSERT(compare_multiline_string(test_get_captured_console(),
+					     exp_output) == 0);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
@@ -290,6 +345,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_history_stash);
 	RUN_TEST(test_history_list);
 	RUN_TEST(test_output_channel);
+	RUN_TEST(test_prefix_match);
+	RUN_TEST(test_tab_complete);
+	RUN_TEST(test_tab_list);
 
 	test_print_result();
 }
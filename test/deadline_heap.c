@@ -0,0 +1,148 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the deadline min-heap backing the timer module.
+ */
+
+#include "common.h"
+#include "deadline_heap.h"
+#include "test_util.h"
+#include "util.h"
+
+#define HEAP_IDS 32
+
+static timestamp_t deadline[HEAP_IDS];
+static uint8_t heap_ids[HEAP_IDS];
+static uint8_t heap_pos[HEAP_IDS];
+static struct deadline_heap heap = {
+	.deadline = deadline,
+	.heap = heap_ids,
+	.pos = heap_pos,
+};
+
+/* Which IDs the test has queued, to check the heap against */
+static uint32_t queued;
+
+static void heap_reset(void)
+{
+	memset(heap_pos, 0, sizeof(heap_pos));
+	heap.size = 0;
+	queued = 0;
+}
+
+static void arm(int id, uint64_t when)
+{
+	deadline[id].val = when;
+	deadline_heap_insert(&heap, id);
+	queued |= BIT(id);
+}
+
+static void cancel(int id)
+{
+	deadline_heap_remove(&heap, id);
+	queued &= ~BIT(id);
+}
+
+/* Check the heap holds exactly the queued IDs, with the earliest first */
+static int check_heap(void)
+{
+	uint64_t earliest = UINT64_MAX;
+	int id, i;
+
+	TEST_EQ(heap.size, __builtin_popcount(queued), "%d");
+
+	for (id = 0; id < HEAP_IDS; id++) {
+		TEST_EQ(!!deadline_heap_queued(&heap, id), !!(queued & BIT(id)),
+			"%d");
+		if (queued & BIT(id))
+			earliest = MIN(earliest, deadline[id].val);
+	}
+
+	for (i = 0; i < heap.size; i++) {
+		TEST_EQ(heap_pos[heap_ids[i]], i + 1, "%d");
+		/* Every ID's deadline is no earlier than its parent's */
+		if (i)
+			TEST_ASSERT(deadline[heap_ids[(i - 1) / 2]].val <=
+				    deadline[heap_ids[i]].val);
+	}
+
+	if (queued)
+		TEST_ASSERT(deadline[deadline_heap_first(&heap)].val ==
+			    earliest);
+	else
+		TEST_EQ(deadline_heap_first(&heap), -1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_empty(void)
+{
+	heap_reset();
+	TEST_EQ(check_heap(), EC_SUCCESS, "%d");
+
+	arm(5, 100);
+	TEST_EQ(deadline_heap_first(&heap), 5, "%d");
+	cancel(5);
+	TEST_EQ(check_heap(), EC_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_expire_in_order(void)
+{
+	uint64_t last = 0;
+	int id;
+
+	heap_reset();
+	for (id = 0; id < HEAP_IDS; id++)
+		arm(id, (id * 7919) % 101);
+	TEST_EQ(check_heap(), EC_SUCCESS, "%d");
+
+	/* Taking the first ID each time yields the deadlines in order */
+	while ((id = deadline_heap_first(&heap)) >= 0) {
+		TEST_ASSERT(deadline[id].val >= last);
+		last = deadline[id].val;
+		cancel(id);
+		TEST_EQ(check_heap(), EC_SUCCESS, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+static int test_random_ops(void)
+{
+	uint32_t seed = 1;
+	int i, id;
+
+	heap_reset();
+	for (i = 0; i < 5000; i++) {
+		seed = prng(seed);
+		id = seed % HEAP_IDS;
+
+		if (queued & BIT(id))
+			cancel(id);
+		else
+			/* Few distinct deadlines, so ties are common */
+			arm(id, (seed >> 8) % 64);
+
+		/* Sometimes expire the first timer, as the interrupt does */
+		if ((seed >> 16) % 4 == 0 && queued)
+			cancel(deadline_heap_first(&heap));
+
+		TEST_EQ(check_heap(), EC_SUCCESS, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_empty);
+	RUN_TEST(test_expire_in_order);
+	RUN_TEST(test_random_ops);
+
+	test_print_result();
+}
@@ -274,6 +274,11 @@ void dpm_run(int port)
 {
 }
 
+bool dpm_has_work(int port)
+{
+	return false;
+}
+
 static enum tcpc_rp_value lcl_rp;
 __overridable void typec_select_src_current_limit_rp(int port,
 						  enum tcpc_rp_value rp)
@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "hooks.h"
+#include "link_defs.h"
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
@@ -66,6 +67,45 @@ static const struct deferred_data non_deferred_func_data = {
 	non_deferred_func
 };
 
+/*
+ * HOOK_BATTERY_SOC_CHANGE hooks, declared out of priority order to check that
+ * hook_notify() calls them sorted.  Each records its priority when called.
+ */
+static int notify_prio[8];
+static int notify_count;
+
+static void record_notify(int prio)
+{
+	if (notify_count < ARRAY_SIZE(notify_prio))
+		notify_prio[notify_count] = prio;
+	notify_count++;
+}
+
+static void soc_hook_last(void)
+{
+	record_notify(HOOK_PRIO_LAST);
+}
+DECLARE_HOOK(HOOK_BATTERY_SOC_CHANGE, soc_hook_last, HOOK_PRIO_LAST);
+
+static void soc_hook_default(void)
+{
+	record_notify(HOOK_PRIO_DEFAULT);
+}
+DECLARE_HOOK(HOOK_BATTERY_SOC_CHANGE, soc_hook_default, HOOK_PRIO_DEFAULT);
+
+static void soc_hook_first(void)
+{
+	record_notify(HOOK_PRIO_FIRST);
+}
+DECLARE_HOOK(HOOK_BATTERY_SOC_CHANGE, soc_hook_first, HOOK_PRIO_FIRST);
+
+static void soc_hook_default2(void)
+{
+	record_notify(HOOK_PRIO_DEFAULT + 1);
+}
+DECLARE_HOOK(HOOK_BATTERY_SOC_CHANGE, soc_hook_default2,
+	     HOOK_PRIO_DEFAULT + 1);
+
 static int test_init_hook(void)
 {
 	TEST_ASSERT(init_hook_count == 1);
@@ -105,6 +145,75 @@ static int test_priority(void)
 	return EC_SUCCESS;
 }
 
+static int test_notify_order(void)
+{
+	int i;
+
+	notify_count = 0;
+	hook_notify(HOOK_BATTERY_SOC_CHANGE);
+	TEST_EQ(notify_count, 4, "%d");
+	TEST_EQ(notify_prio[0], HOOK_PRIO_FIRST, "%d");
+	TEST_EQ(notify_prio[1], HOOK_PRIO_DEFAULT, "%d");
+	TEST_EQ(notify_prio[2], HOOK_PRIO_DEFAULT + 1, "%d");
+	TEST_EQ(notify_prio[3], HOOK_PRIO_LAST, "%d");
+
+	/* Walking the list again must give the same order */
+	notify_count = 0;
+	hook_notify(HOOK_BATTERY_SOC_CHANGE);
+	for (i = 1; i < notify_count; i++)
+		TEST_ASSERT(notify_prio[i - 1] <= notify_prio[i]);
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Reference implementation of the previous hook_notify(), which rescanned
+ * the whole list for each priority level.  Only used for comparison.
+ */
+static void hook_notify_scan(const struct hook_data *start,
+			     const struct hook_data *end)
+{
+	const struct hook_data *p;
+	int count = end - start, called = 0;
+	int last_prio = HOOK_PRIO_FIRST - 1, prio;
+
+	while (called < count) {
+		for (p = start, prio = HOOK_PRIO_LAST + 1; p < end; p++) {
+			if (p->priority < prio && p->priority > last_prio)
+				prio = p->priority;
+		}
+		last_prio = prio;
+
+		for (p = start; p < end; p++) {
+			if (p->priority == prio) {
+				called++;
+				p->routine();
+			}
+		}
+	}
+}
+
+static int test_notify_latency(void)
+{
+	const int loops = 10000;
+	timestamp_t t0, t1, t2;
+	int i;
+
+	t0 = get_time();
+	for (i = 0; i < loops; i++)
+		hook_notify_scan(__hooks_battery_soc_change,
+				 __hooks_battery_soc_change_end);
+	t1 = get_time();
+	for (i = 0; i < loops; i++)
+		hook_notify(HOOK_BATTERY_SOC_CHANGE);
+	t2 = get_time();
+
+	ccprintf("hook_notify x%d: scan %lld us, sorted %lld us\n", loops,
+		 (long long)(t1.val - t0.val), (long long)(t2.val - t1.val));
+
+	return EC_SUCCESS;
+}
+
 static int test_deferred(void)
 {
 	deferred_call_count = 0;
@@ -134,6 +243,65 @@ static int test_deferred(void)
 	return EC_SUCCESS;
 }
 
+/* Deferred functions which record the order they are called in */
+static char deferred_order[8];
+static int deferred_order_count;
+
+static void deferred_record(char c)
+{
+	if (deferred_order_count < sizeof(deferred_order) - 1)
+		deferred_order[deferred_order_count++] = c;
+}
+
+static void deferred_a(void)
+{
+	deferred_record('a');
+}
+DECLARE_DEFERRED(deferred_a);
+
+static void deferred_b(void)
+{
+	deferred_record('b');
+}
+DECLARE_DEFERRED(deferred_b);
+
+static void deferred_c(void)
+{
+	deferred_record('c');
+}
+DECLARE_DEFERRED(deferred_c);
+
+static void deferred_d(void)
+{
+	deferred_record('d');
+}
+DECLARE_DEFERRED(deferred_d);
+
+static int test_deferred_order(void)
+{
+	memset(deferred_order, 0, sizeof(deferred_order));
+	deferred_order_count = 0;
+
+	/* Armed in the opposite order to their deadlines */
+	hook_call_deferred(&deferred_d_data, 40 * MSEC);
+	hook_call_deferred(&deferred_c_data, 30 * MSEC);
+	hook_call_deferred(&deferred_b_data, 20 * MSEC);
+	hook_call_deferred(&deferred_a_data, 10 * MSEC);
+
+	/* Move c to the front, then d to the back, and cancel b */
+	hook_call_deferred(&deferred_c_data, 5 * MSEC);
+	hook_call_deferred(&deferred_d_data, 60 * MSEC);
+	hook_call_deferred(&deferred_b_data, -1);
+
+	usleep(50 * MSEC);
+	TEST_ASSERT(!memcmp(deferred_order, "ca", 3));
+
+	usleep(50 * MSEC);
+	TEST_ASSERT(!memcmp(deferred_order, "cad", 4));
+
+	return EC_SUCCESS;
+}
+
 static int repeating_deferred_count;
 static void deferred_repeating_func(void);
 DECLARE_DEFERRED(deferred_repeating_func);
@@ -166,7 +334,10 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_init_hook);
 	RUN_TEST(test_ticks);
 	RUN_TEST(test_priority);
+	RUN_TEST(test_notify_order);
+	RUN_TEST(test_notify_latency);
 	RUN_TEST(test_deferred);
+	RUN_TEST(test_deferred_order);
 	RUN_TEST(test_repeating_deferred);
 
 	test_print_result();
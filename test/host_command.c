@@ -300,6 +300,360 @@ static int test_hostcmd_clears_unused_data(void)
 	return EC_SUCCESS;
 }
 
+static int test_hostcmd_dispatch_speed(void)
+{
+	const int loops = 1000;
+	timestamp_t t0, t1;
+	int i;
+
+	t0 = get_time();
+	for (i = 0; i < loops; ++i) {
+		hostcmd_fill_in_default();
+		hostcmd_send();
+	}
+	t1 = get_time();
+
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(r->out_data, 0x12243648, "0x%x");
+	ccprintf("Host command dispatch: %lld us for %d packets\n",
+		 (long long)(t1.val - t0.val), loops);
+
+	return EC_SUCCESS;
+}
+
+static void hostcmd_fill_flash_read(void)
+{
+	struct ec_params_flash_read *fp =
+		(struct ec_params_flash_read *)(req_buf + sizeof(*req));
+
+	hostcmd_fill_in_default();
+	req->command = EC_CMD_FLASH_READ;
+	req->data_len = sizeof(*fp);
+	fp->offset = 0x100;
+	fp->size = 64;
+	pkt.request_size = sizeof(*req) + sizeof(*fp);
+}
+
+static int test_hostcmd_response_iov(void)
+{
+	const struct host_response_iov *iov;
+	uint8_t copied[64];
+	int csum = 0;
+	int size = 0;
+	int i, j;
+
+	/* Without driver support, the data is copied in behind the header */
+	hostcmd_fill_flash_read();
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(pkt.response_iov_count, 0, "%d");
+	TEST_EQ(resp->data_len, 64, "%d");
+	TEST_EQ(calculate_checksum(resp_buf,
+				   sizeof(*resp) + resp->data_len), 0, "%d");
+	memcpy(copied, resp_buf + sizeof(*resp), sizeof(copied));
+
+	/* With it, the data is left in mapped flash for the driver */
+	hostcmd_fill_flash_read();
+	pkt.response_iov_ok = 1;
+	hostcmd_send();
+	pkt.response_iov_ok = 0;
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(pkt.response_iov_count, 1, "%d");
+	TEST_EQ(resp->data_len, 64, "%d");
+	TEST_ASSERT(pkt.response_size == sizeof(*resp) + resp->data_len);
+
+	for (i = 0; i < sizeof(*resp); i++)
+		csum += resp_buf[i];
+	for (j = 0; j < pkt.response_iov_count; j++) {
+		iov = pkt.response_iov + j;
+		TEST_ASSERT(size + iov->size <= sizeof(copied));
+		TEST_ASSERT(!memcmp(iov->data, copied + size, iov->size));
+		for (i = 0; i < iov->size; i++)
+			csum += ((const uint8_t *)iov->data)[i];
+		size += iov->size;
+	}
+	TEST_EQ(size, resp->data_len, "%d");
+	TEST_EQ((uint8_t)csum, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Commands which finish after their response, as slow commands do */
+#define TEST_CMD_IN_PROGRESS 0x01f0
+#define TEST_CMD_EARLY_RESPONSE 0x01f1
+/* A command which takes a while */
+#define TEST_CMD_SLOW 0x01f2
+#define TEST_CMD_SLOW_US 2000
+
+static enum ec_status test_cmd_in_progress(struct host_cmd_handler_args *args)
+{
+	return EC_RES_IN_PROGRESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(TEST_CMD_IN_PROGRESS, test_cmd_in_progress,
+			     EC_VER_MASK(0));
+
+static enum ec_status
+test_cmd_early_response(struct host_cmd_handler_args *args)
+{
+	args->result = EC_RES_SUCCESS;
+	host_send_response(args);
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(TEST_CMD_EARLY_RESPONSE, test_cmd_early_response,
+			     EC_VER_MASK(0));
+
+static enum ec_status test_cmd_slow(struct host_cmd_handler_args *args)
+{
+	udelay(TEST_CMD_SLOW_US);
+	return EC_RES_SUCCESS;
+}
+DECLARE_PRIVATE_HOST_COMMAND(TEST_CMD_SLOW, test_cmd_slow, EC_VER_MASK(0));
+
+static uint8_t *batch_add(uint8_t *buf, int command, const void *data,
+			  int size)
+{
+	struct ec_batch_request *b = (struct ec_batch_request *)buf;
+
+	b->command = command;
+	b->command_version = 0;
+	b->reserved = 0;
+	b->data_len = size;
+	b->reserved2 = 0;
+	memcpy(b + 1, data, size);
+
+	return buf + sizeof(*b) + ((size + 3) & ~3);
+}
+
+static void hostcmd_fill_batch(int flags)
+{
+	struct ec_params_batch *bp =
+		(struct ec_params_batch *)(req_buf + sizeof(*req));
+	struct ec_params_hello hello = { .in_data = 0x01020304 };
+	uint8_t *b = (uint8_t *)(bp + 1);
+	uint8_t odd[3] = { 1, 2, 3 };
+
+	hostcmd_fill_in_default();
+	memset(req_buf + sizeof(*req), 0, BUFFER_SIZE - sizeof(*req));
+
+	bp->count = 3;
+	bp->flags = flags;
+	b = batch_add(b, EC_CMD_HELLO, &hello, sizeof(hello));
+	/* Unknown command, with params that need padding */
+	b = batch_add(b, 0xff, odd, sizeof(odd));
+	b = batch_add(b, EC_CMD_HELLO, &hello, sizeof(hello));
+
+	req->command = EC_CMD_BATCH;
+	req->data_len = b - (uint8_t *)bp;
+	pkt.request_size = sizeof(*req) + req->data_len;
+}
+
+static int test_hostcmd_batch(void)
+{
+	struct ec_response_batch *br =
+		(struct ec_response_batch *)(resp_buf + sizeof(*resp));
+	struct ec_batch_response *sub = (struct ec_batch_response *)(br + 1);
+	struct ec_response_hello *hello;
+
+	hostcmd_fill_batch(0);
+	hostcmd_send();
+
+	TEST_EQ(calculate_checksum(resp_buf,
+				   sizeof(*resp) + resp->data_len), 0, "%d");
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(br->count, 3, "%d");
+	TEST_ASSERT(resp->data_len == sizeof(*br) + 3 * sizeof(*sub) + 2 * 4);
+
+	TEST_EQ(sub->result, EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(sub->data_len == sizeof(*hello));
+	hello = (struct ec_response_hello *)(sub + 1);
+	TEST_EQ(hello->out_data, 0x01020304 + 0x01020304, "0x%x");
+
+	sub = (struct ec_batch_response *)(hello + 1);
+	TEST_EQ(sub->result, EC_RES_INVALID_COMMAND, "%d");
+	TEST_EQ(sub->data_len, 0, "%d");
+
+	sub++;
+	TEST_EQ(sub->result, EC_RES_SUCCESS, "%d");
+	TEST_ASSERT(sub->data_len == sizeof(*hello));
+
+	/* Same batch, but give up at the unknown command */
+	hostcmd_fill_batch(EC_BATCH_FLAG_STOP_ON_ERROR);
+	hostcmd_send();
+
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(br->count, 2, "%d");
+	TEST_ASSERT(resp->data_len == sizeof(*br) + 2 * sizeof(*sub) + 4);
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_batch_truncated(void)
+{
+	hostcmd_fill_batch(0);
+
+	/* Last sub-request claims more params than the packet holds */
+	req->data_len -= 4;
+	pkt.request_size -= 4;
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_INVALID_PARAM, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_batch_async(void)
+{
+	struct ec_params_batch *bp =
+		(struct ec_params_batch *)(req_buf + sizeof(*req));
+	struct ec_response_batch *br =
+		(struct ec_response_batch *)(resp_buf + sizeof(*resp));
+	struct ec_batch_response *sub = (struct ec_batch_response *)(br + 1);
+	uint8_t *b = (uint8_t *)(bp + 1);
+	uint8_t none = 0;
+
+	hostcmd_fill_in_default();
+	memset(req_buf + sizeof(*req), 0, BUFFER_SIZE - sizeof(*req));
+	bp->count = 2;
+	b = batch_add(b, EC_PRIVATE_HOST_COMMAND_VALUE(TEST_CMD_IN_PROGRESS),
+		      &none, 0);
+	b = batch_add(b, EC_PRIVATE_HOST_COMMAND_VALUE(TEST_CMD_EARLY_RESPONSE),
+		      &none, 0);
+	req->command = EC_CMD_BATCH;
+	req->data_len = b - (uint8_t *)bp;
+	pkt.request_size = sizeof(*req) + req->data_len;
+	hostcmd_send();
+
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+	TEST_EQ(br->count, 2, "%d");
+	TEST_EQ(sub[0].result, EC_RES_INVALID_COMMAND, "%d");
+	TEST_EQ(sub[1].result, EC_RES_INVALID_COMMAND, "%d");
+
+	/* The batch itself completed, so the next command is answered */
+	hostcmd_fill_in_default();
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_hostcmd_stats(void)
+{
+	struct ec_params_hello hello_p = { .in_data = 1 };
+	struct ec_response_hello hello_r;
+	struct ec_params_hostcmd_stats p = { .index = 0 };
+	uint8_t buf[sizeof(struct ec_response_hostcmd_stats) +
+		    2 * sizeof(struct ec_hostcmd_stats_entry)];
+	struct ec_response_hostcmd_stats *r = (void *)buf;
+	const struct ec_hostcmd_stats_entry *e;
+	int found = 0;
+	int i, j, sum;
+
+	p.flags = EC_HOSTCMD_STATS_FLAG_RESET;
+	TEST_ASSERT(test_send_host_command(EC_CMD_HOSTCMD_STATS, 0, &p,
+					   sizeof(p), buf, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+	TEST_EQ(r->count, 0, "%d");
+
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT(test_send_host_command(EC_CMD_HELLO, 0, &hello_p,
+						   sizeof(hello_p), &hello_r,
+						   sizeof(hello_r)) ==
+			    EC_RES_SUCCESS);
+
+	/* Page through with room for two entries at a time */
+	p.flags = 0;
+	do {
+		TEST_ASSERT(test_send_host_command(EC_CMD_HOSTCMD_STATS, 0,
+						   &p, sizeof(p), buf,
+						   sizeof(buf)) ==
+			    EC_RES_SUCCESS);
+		TEST_ASSERT(r->count <= 2);
+		for (i = 0; i < r->count; i++) {
+			e = r->entries + i;
+			TEST_ASSERT(e->count > 0);
+			TEST_ASSERT(e->max_us <= e->total_us);
+			for (j = 0, sum = 0; j < EC_HOSTCMD_STATS_BUCKETS; j++)
+				sum += e->histogram[j];
+			TEST_EQ(sum, e->count, "%d");
+			if (e->command == EC_CMD_HELLO) {
+				TEST_EQ(e->count, 3, "%d");
+				found++;
+			}
+		}
+		p.index = r->next_index;
+	} while (p.index);
+
+	TEST_EQ(found, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Look up the stats of one command, or return 0 if it has none */
+static int hostcmd_get_stats(int command, struct ec_hostcmd_stats_entry *out)
+{
+	struct ec_params_hostcmd_stats p = { .index = 0 };
+	uint8_t buf[sizeof(struct ec_response_hostcmd_stats) +
+		    2 * sizeof(struct ec_hostcmd_stats_entry)];
+	struct ec_response_hostcmd_stats *r = (void *)buf;
+	int i;
+
+	do {
+		if (test_send_host_command(EC_CMD_HOSTCMD_STATS, 0, &p,
+					   sizeof(p), buf, sizeof(buf)))
+			return 0;
+		for (i = 0; i < r->count; i++) {
+			if (r->entries[i].command == command) {
+				*out = r->entries[i];
+				return 1;
+			}
+		}
+		p.index = r->next_index;
+	} while (p.index);
+
+	return 0;
+}
+
+static int test_hostcmd_stats_batch(void)
+{
+	struct ec_params_batch *bp =
+		(struct ec_params_batch *)(req_buf + sizeof(*req));
+	struct ec_params_hostcmd_stats p = {
+		.flags = EC_HOSTCMD_STATS_FLAG_RESET,
+	};
+	uint8_t buf[sizeof(struct ec_response_hostcmd_stats) +
+		    sizeof(struct ec_hostcmd_stats_entry)];
+	struct ec_hostcmd_stats_entry batch, slow;
+	uint8_t *b = (uint8_t *)(bp + 1);
+	uint8_t none = 0;
+
+	TEST_ASSERT(test_send_host_command(EC_CMD_HOSTCMD_STATS, 0, &p,
+					   sizeof(p), buf, sizeof(buf)) ==
+		    EC_RES_SUCCESS);
+
+	hostcmd_fill_in_default();
+	memset(req_buf + sizeof(*req), 0, BUFFER_SIZE - sizeof(*req));
+	bp->count = 2;
+	b = batch_add(b, EC_PRIVATE_HOST_COMMAND_VALUE(TEST_CMD_SLOW),
+		      &none, 0);
+	b = batch_add(b, EC_PRIVATE_HOST_COMMAND_VALUE(TEST_CMD_SLOW),
+		      &none, 0);
+	req->command = EC_CMD_BATCH;
+	req->data_len = b - (uint8_t *)bp;
+	pkt.request_size = sizeof(*req) + req->data_len;
+	hostcmd_send();
+	TEST_EQ(resp->result, EC_RES_SUCCESS, "%d");
+
+	/* Sub-commands are counted under their own entry only */
+	TEST_ASSERT(hostcmd_get_stats(
+		EC_PRIVATE_HOST_COMMAND_VALUE(TEST_CMD_SLOW), &slow));
+	TEST_ASSERT(hostcmd_get_stats(EC_CMD_BATCH, &batch));
+	TEST_EQ(slow.count, 2, "%d");
+	TEST_EQ(batch.count, 1, "%d");
+	TEST_ASSERT(slow.total_us >= 2 * TEST_CMD_SLOW_US);
+	TEST_ASSERT(batch.total_us < TEST_CMD_SLOW_US);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	wait_for_task_started();
@@ -315,6 +669,13 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_hostcmd_invalid_checksum);
 	RUN_TEST(test_hostcmd_reuse_response_buffer);
 	RUN_TEST(test_hostcmd_clears_unused_data);
+	RUN_TEST(test_hostcmd_dispatch_speed);
+	RUN_TEST(test_hostcmd_batch);
+	RUN_TEST(test_hostcmd_batch_truncated);
+	RUN_TEST(test_hostcmd_batch_async);
+	RUN_TEST(test_hostcmd_response_iov);
+	RUN_TEST(test_hostcmd_stats);
+	RUN_TEST(test_hostcmd_stats_batch);
 
 	test_print_result();
 }
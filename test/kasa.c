@@ -7,6 +7,7 @@
 #include "kasa.h"
 #include "test_util.h"
 #include "motion_sense.h"
+#include "timer.h"
 #include <stdio.h>
 
 struct motion_sensor_t motion_sensors[] = {};
@@ -62,12 +63,60 @@ static int test_kasa_calculate(void)
 	return EC_SUCCESS;
 }
 
+#define BENCHMARK_SAMPLES 100000
+
+static int test_kasa_benchmark(void)
+{
+	struct kasa_fit kasa;
+	fpv3_t bias;
+	float radius;
+	timestamp_t t0, t1;
+	int i;
+
+	kasa_reset(&kasa);
+	t0 = get_time();
+	for (i = 0; i < BENCHMARK_SAMPLES; i++) {
+		/* Points on a unit sphere around (0.01, 0.01, 0.01) */
+		switch (i % 6) {
+		case 0:
+			kasa_accumulate(&kasa, 1.01f, 0.01f, 0.01f);
+			break;
+		case 1:
+			kasa_accumulate(&kasa, -0.99f, 0.01f, 0.01f);
+			break;
+		case 2:
+			kasa_accumulate(&kasa, 0.01f, 1.01f, 0.01f);
+			break;
+		case 3:
+			kasa_accumulate(&kasa, 0.01f, -0.99f, 0.01f);
+			break;
+		case 4:
+			kasa_accumulate(&kasa, 0.01f, 0.01f, 1.01f);
+			break;
+		default:
+			kasa_accumulate(&kasa, 0.01f, 0.01f, -0.99f);
+			break;
+		}
+	}
+	t1 = get_time();
+	ccprintf("%d kasa_accumulate() in %lld us\n", BENCHMARK_SAMPLES,
+		 (long long)(t1.val - t0.val));
+
+	/* The float sums lose some precision over this many samples */
+	kasa_compute(&kasa, bias, &radius);
+	TEST_NEAR(bias[0], 0.01f, 0.001f, "%f");
+	TEST_NEAR(radius, 1.0f, 0.001f, "%f");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_kasa_reset);
 	RUN_TEST(test_kasa_calculate);
+	RUN_TEST(test_kasa_benchmark);
 
 	test_print_result();
 }
@@ -90,12 +90,33 @@ static int test_lid_angle_less180(void)
 	return EC_SUCCESS;
 }
 
+static int test_read_group(void)
+{
+	int i;
+
+	/*
+	 * Both sensors sit on the same mock chip and are due at the same
+	 * time: they must be read together, never one by one.
+	 */
+	test_read_count[CONFIG_LID_ANGLE_SENSOR_BASE] = 0;
+	test_read_count[CONFIG_LID_ANGLE_SENSOR_LID] = 0;
+	test_read_group_count = 0;
+	for (i = 0; i < 5; i++)
+		wait_for_valid_sample();
+
+	TEST_ASSERT(test_read_group_count >= 5);
+	TEST_ASSERT(test_read_count[CONFIG_LID_ANGLE_SENSOR_BASE] == 0);
+	TEST_ASSERT(test_read_count[CONFIG_LID_ANGLE_SENSOR_LID] == 0);
+
+	return EC_SUCCESS;
+}
 
 void run_test(int argc, char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_lid_angle_less180);
+	RUN_TEST(test_read_group);
 
 	test_print_result();
 }
@@ -20,12 +20,29 @@ static int accel_init(const struct motion_sensor_t *s)
 	return EC_SUCCESS;
 }
 
+int test_read_count[2] = { 0 };
+int test_read_group_count;
+
 static int accel_read(const struct motion_sensor_t *s, intv3_t v)
 {
+	test_read_count[s - motion_sensors]++;
 	rotate(s->xyz, *s->rot_standard_ref, v);
 	return EC_SUCCESS;
 }
 
+static int accel_read_group(const struct motion_sensor_t *s, uint32_t group)
+{
+	int i;
+
+	test_read_group_count++;
+	for (i = 0; i < motion_sensor_count; i++)
+		if (group & BIT(i))
+			rotate(motion_sensors[i].xyz,
+			       *motion_sensors[i].rot_standard_ref,
+			       motion_sensors[i].raw_xyz);
+	return EC_SUCCESS;
+}
+
 static int accel_get_range(const struct motion_sensor_t *s)
 {
 	return s->default_range;
@@ -70,6 +87,7 @@ static int accel_get_rms_noise(const struct motion_sensor_t *s)
 const struct accelgyro_drv test_motion_sense = {
 	.init = accel_init,
 	.read = accel_read,
+	.read_group = accel_read_group,
 	.get_range = accel_get_range,
 	.get_resolution = accel_get_resolution,
 	.set_data_rate = accel_set_data_rate,
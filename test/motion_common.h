@@ -28,6 +28,10 @@ extern enum chipset_state_mask sensor_active;
 extern struct motion_sensor_t motion_sensors[];
 extern const unsigned int motion_sensor_count;
 
+/* Reads of a single sensor and of a group of sensors, per mock driver */
+extern int test_read_count[];
+extern int test_read_group_count;
+
 void wait_for_valid_sample(void);
 void feed_accel_data(const float *array, int *idx,
 		int (filler)(const struct motion_sensor_t *s, const float f));
@@ -12,6 +12,7 @@
 #include "hwtimer.h"
 #include "timer.h"
 #include "accelgyro.h"
+#include "../util/ec_motion_fifo.h"
 #include <sys/types.h>
 
 struct motion_sensor_t motion_sensors[] = {
@@ -343,6 +344,146 @@ static int test_commit_non_data_or_timestamp_entries(void)
 	return EC_SUCCESS;
 }
 
+static uint8_t packed[CONFIG_ACCEL_FIFO_SIZE * MOTIONSENSE_FIFO_PACKED_MAX_ENTRY];
+static struct ec_response_motion_sensor_data unpacked[CONFIG_ACCEL_FIFO_SIZE];
+
+/*
+ * Fill the fifo with samples of both sensors moving slowly every 10 ms, an
+ * extra timestamp every 10 samples, then an ODR change and a flush event.
+ *
+ * @return The number of entries added.
+ */
+static int fill_fifo(int samples)
+{
+	struct ec_response_motion_sensor_data v;
+	int count = 2;
+	int i, j;
+
+	motion_sense_fifo_reset();
+	for (i = 0; i < motion_sensor_count; i++) {
+		motion_sensors[i].oversampling_ratio = 1;
+		motion_sensors[i].oversampling = 0;
+	}
+
+	for (i = 0; i < samples; i++) {
+		if (i % 10 == 0) {
+			motion_sense_fifo_add_timestamp(i * 10000 - 10);
+			count++;
+		}
+		for (j = 0; j < motion_sensor_count; j++) {
+			v.flags = i == samples / 2 ?
+				MOTIONSENSE_SENSOR_FLAG_WAKEUP : 0;
+			v.sensor_num = j;
+			v.data[0] = 1000 * j + (i % 5);
+			v.data[1] = -1000 * j - (i % 7);
+			v.data[2] = 16384 + (i % 3);
+			if (i == samples - 1) {
+				v.data[0] = INT16_MIN;
+				v.data[1] = INT16_MAX;
+			}
+			motion_sense_fifo_stage_data(&v, motion_sensors + j, 3,
+						     i * 10000 + j * 100);
+			motion_sense_fifo_commit_data();
+			/* Tight timestamps add a timestamp before the data. */
+			count += IS_ENABLED(CONFIG_SENSOR_TIGHT_TIMESTAMPS) ?
+				2 : 1;
+		}
+	}
+	motion_sense_fifo_insert_async_event(motion_sensors, ASYNC_EVENT_ODR);
+	motion_sense_fifo_insert_async_event(motion_sensors + 1,
+					     ASYNC_EVENT_FLUSH);
+
+	return count;
+}
+
+static int test_read_packed_round_trip(void)
+{
+	int count, read_count, i;
+
+	count = fill_fifo(20);
+	read_count = motion_sense_fifo_read(
+		sizeof(data), CONFIG_ACCEL_FIFO_SIZE, data, &data_bytes_read);
+	TEST_EQ(read_count, count, "%d");
+
+	fill_fifo(20);
+	read_count = motion_sense_fifo_read_packed(
+		sizeof(packed), CONFIG_ACCEL_FIFO_SIZE, packed,
+		&data_bytes_read);
+	TEST_EQ(read_count, count, "%d");
+	TEST_EQ(ec_motion_fifo_unpack(packed, data_bytes_read, read_count,
+				      unpacked, ARRAY_SIZE(unpacked)),
+		count, "%d");
+	for (i = 0; i < count; i++) {
+		TEST_EQ(unpacked[i].flags, data[i].flags, "%d");
+		TEST_EQ(unpacked[i].sensor_num, data[i].sensor_num, "%d");
+		/* Only the time of the async events differs between fills. */
+		if (i >= count - 2)
+			continue;
+		if (data[i].flags & MOTIONSENSE_SENSOR_FLAG_TIMESTAMP)
+			TEST_EQ(unpacked[i].timestamp, data[i].timestamp, "%u");
+		else
+			TEST_ASSERT_ARRAY_EQ(unpacked[i].data, data[i].data, 3);
+	}
+
+	/* Corrupt data is rejected. */
+	TEST_EQ(ec_motion_fifo_unpack(packed, data_bytes_read - 1, read_count,
+				      unpacked, ARRAY_SIZE(unpacked)),
+		-1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_read_packed_capacity(void)
+{
+	int count, read_count, total = 0;
+	int i = 0;
+
+	count = fill_fifo(20);
+	while (total < count) {
+		read_count = motion_sense_fifo_read_packed(
+			16, CONFIG_ACCEL_FIFO_SIZE, packed, &data_bytes_read);
+		TEST_ASSERT(read_count > 0);
+		TEST_ASSERT(data_bytes_read <= 16);
+		TEST_EQ(ec_motion_fifo_unpack(packed, data_bytes_read,
+					      read_count, unpacked + total,
+					      ARRAY_SIZE(unpacked) - total),
+			read_count, "%d");
+		total += read_count;
+		TEST_ASSERT(++i < count);
+	}
+	TEST_EQ(total, count, "%d");
+	TEST_EQ(motion_sense_fifo_read_packed(sizeof(packed),
+					      CONFIG_ACCEL_FIFO_SIZE, packed,
+					      &data_bytes_read),
+		0, "%d");
+
+	/* Only the count requested is read. */
+	fill_fifo(20);
+	TEST_EQ(motion_sense_fifo_read_packed(sizeof(packed), 5, packed,
+					      &data_bytes_read),
+		5, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_read_packed_size(void)
+{
+	int count, read_count;
+
+	count = fill_fifo(60);
+	read_count = motion_sense_fifo_read_packed(
+		sizeof(packed), CONFIG_ACCEL_FIFO_SIZE, packed,
+		&data_bytes_read);
+	TEST_EQ(read_count, count, "%d");
+	ccprintf("%d entries: %d bytes packed, %d bytes unpacked\n", count,
+		 data_bytes_read,
+		 (int)(count * sizeof(struct ec_response_motion_sensor_data)));
+	TEST_ASSERT(data_bytes_read * 3 <
+		    count * sizeof(struct ec_response_motion_sensor_data));
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	motion_sense_fifo_commit_data();
@@ -372,6 +513,9 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_spread_data_by_collection_rate);
 	RUN_TEST(test_spread_double_commit_same_timestamp);
 	RUN_TEST(test_commit_non_data_or_timestamp_entries);
+	RUN_TEST(test_read_packed_round_trip);
+	RUN_TEST(test_read_packed_capacity);
+	RUN_TEST(test_read_packed_size);
 
 	test_print_result();
 }
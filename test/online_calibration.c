@@ -89,11 +89,15 @@ static struct mag_cal_t lid_mag_cal_data;
 
 static bool next_accel_cal_accumulate_result;
 static fpv3_t next_accel_cal_bias;
+static fpv3_t last_accel_cal_data;
 
 bool accel_cal_accumulate(
 	struct accel_cal *cal, uint32_t sample_time, fp_t x, fp_t y, fp_t z,
 	fp_t temp)
 {
+	last_accel_cal_data[X] = x;
+	last_accel_cal_data[Y] = y;
+	last_accel_cal_data[Z] = z;
 	if (next_accel_cal_accumulate_result) {
 		cal->bias[X] = next_accel_cal_bias[X];
 		cal->bias[Y] = next_accel_cal_bias[Y];
@@ -245,6 +249,84 @@ int test_mag_reading_updated_cal(void)
 	return EC_SUCCESS;
 }
 
+static int test_accel_data_scaling(void)
+{
+	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
+						  EC_SUCCESS, 0, NULL };
+	struct ec_response_motion_sensor_data data;
+	int rc;
+
+	mock_read_temp_results = &expected;
+	next_accel_cal_accumulate_result = false;
+	data.sensor_num = BASE;
+
+	/* Full scale either way is the range, 4g by default */
+	data.data[X] = 0x7fff;
+	data.data[Y] = -0x8000;
+	data.data[Z] = 0;
+	rc = online_calibration_process_data(
+		&data, &motion_sensors[BASE], __hw_clock_source_read());
+	TEST_EQ(rc, EC_SUCCESS, "%d");
+	TEST_NEAR(last_accel_cal_data[X], 4.0f, 0.0001f, "%f");
+	TEST_NEAR(last_accel_cal_data[Y], -4.0f, 0.0001f, "%f");
+	TEST_NEAR(last_accel_cal_data[Z], 0.0f, 0.0001f, "%f");
+
+	data.data[X] = 0x4000;
+	data.data[Y] = -0x4000;
+	data.data[Z] = 1;
+	rc = online_calibration_process_data(
+		&data, &motion_sensors[BASE], __hw_clock_source_read());
+	TEST_EQ(rc, EC_SUCCESS, "%d");
+	TEST_NEAR(last_accel_cal_data[X], 0x4000 * 4.0f / 0x7fff, 0.0001f,
+		  "%f");
+	TEST_NEAR(last_accel_cal_data[Y], -2.0f, 0.0001f, "%f");
+	TEST_NEAR(last_accel_cal_data[Z], 4.0f / 0x7fff, 0.0000001f, "%f");
+
+	return EC_SUCCESS;
+}
+
+#define BENCHMARK_SAMPLES 10000
+
+static int test_benchmark_process_data(void)
+{
+	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
+						  EC_SUCCESS, 0, NULL };
+	struct ec_response_motion_sensor_data data;
+	timestamp_t t0, t1;
+	int i;
+
+	mock_read_temp_results = &expected;
+	next_accel_cal_accumulate_result = false;
+
+	t0 = get_time();
+	for (i = 0; i < BENCHMARK_SAMPLES; i++) {
+		data.sensor_num = BASE;
+		data.data[X] = i;
+		data.data[Y] = -i;
+		data.data[Z] = 0x4000;
+		online_calibration_process_data(&data, &motion_sensors[BASE],
+						__hw_clock_source_read());
+	}
+	t1 = get_time();
+	ccprintf("%d accel samples in %lld us\n", BENCHMARK_SAMPLES,
+		 (long long)(t1.val - t0.val));
+
+	t0 = get_time();
+	for (i = 0; i < BENCHMARK_SAMPLES; i++) {
+		data.sensor_num = LID;
+		data.data[X] = 200 + (i & 0xff);
+		data.data[Y] = -17 - (i & 0x7f);
+		data.data[Z] = -37;
+		online_calibration_process_data(&data, &motion_sensors[LID],
+						__hw_clock_source_read());
+	}
+	t1 = get_time();
+	ccprintf("%d mag samples in %lld us\n", BENCHMARK_SAMPLES,
+		 (long long)(t1.val - t0.val));
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	mock_read_temp_results = NULL;
@@ -260,6 +342,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_read_temp_twice_after_cache_stale);
 	RUN_TEST(test_new_calibration_value);
 	RUN_TEST(test_mag_reading_updated_cal);
+	RUN_TEST(test_accel_data_scaling);
+	RUN_TEST(test_benchmark_process_data);
 
 	test_print_result();
 }
@@ -10,6 +10,7 @@
 #include "common.h"
 #include "printf.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 #define INIT_VALUE 0x5E
@@ -177,11 +178,26 @@ test_static int test_vsnprintf_int(void)
 	T(expect_success("123",        "%u",    123));
 	T(expect_success("4294967295", "%u",   -1));
 	T(expect_success("18446744073709551615", "%llu", (uint64_t)-1));
+	T(expect_success("-9223372036854775808", "%lld", INT64_MIN));
+	T(expect_success("1000000000000000000", "%llu",
+			 1000000000000000000ULL));
+	T(expect_success("4294967296", "%llu", 1ULL << 32));
+	T(expect_success("2147483647", "%d", INT32_MAX));
+	T(expect_success("-2147483648", "%d", INT32_MIN));
+	T(expect_success("0.000000000123", "%.12d", 123));
+	T(expect_success("4294.967296", "%.6llu", 1ULL << 32));
+	T(expect_success("12345678901.234567891", "%.9llu",
+			 12345678901234567891ULL));
+	T(expect_success("0000000000000000000123", "%022d", 123));
+	T(expect_success("123                   ", "%-22d", 123));
 
 	T(expect_success("0",         "%x",     0));
 	T(expect_success("0",         "%X",     0));
 	T(expect_success("5e",        "%x",     0X5E));
 	T(expect_success("5E",        "%X",     0X5E));
+	T(expect_success("deadbeef",  "%x",     0xdeadbeef));
+	T(expect_success("DEADBEEF",  "%X",     0xdeadbeef));
+	T(expect_success("123456789abcdef0", "%llx", 0x123456789abcdef0ULL));
 
 	/*
 	 * %l is deprecated on 32-bit systems (see crbug.com/984041), but is
@@ -290,6 +306,63 @@ test_static int test_vsnprintf_hexdump(void)
 	return EC_SUCCESS;
 }
 
+test_static int test_vsnprintf_long_output(void)
+{
+	char bytes[40];
+	char expect_hex[2 * sizeof(bytes) + 1];
+	int i;
+
+	for (i = 0; i < sizeof(bytes); i++) {
+		bytes[i] = 0xa0 + i;
+		expect_hex[2 * i] = "0123456789abcdef"[(0xa0 + i) >> 4 & 0xf];
+		expect_hex[2 * i + 1] = "0123456789abcdef"[(0xa0 + i) & 0xf];
+	}
+	expect_hex[2 * sizeof(bytes)] = '\0';
+
+	/* Hex buffers and padding longer than the chunks they are sent in */
+	T(expect_success(expect_hex, "%ph", HEX_BUF(bytes, sizeof(bytes))));
+	T(expect_success("                    abc", "%23s", "abc"));
+	T(expect_success("abc                    |", "%-23s|", "abc"));
+
+	/* Truncation in the middle of runs of characters */
+	T(expect(EC_ERROR_OVERFLOW, "abcd", false, 5, "abcdefgh"));
+	T(expect(EC_ERROR_OVERFLOW, "a123", false, 5, "a%d", 123456));
+	T(expect(EC_ERROR_OVERFLOW, "aa0a", false, 5, "a%ph",
+		 HEX_BUF(bytes, sizeof(bytes))));
+	T(expect(EC_ERROR_OVERFLOW, "x   ", false, 5, "x%20s", "abc"));
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Format lines like the ones the USB-PD and charger tasks print, and report
+ * how long it takes.
+ */
+test_static int test_vsnprintf_benchmark(void)
+{
+	const uint8_t msg[] = {0x61, 0x11, 0x2c, 0x91, 0x01, 0x08,
+			       0x2c, 0xd1, 0x02, 0x00};
+	uint64_t ts = 0x123456789aULL;
+	timestamp_t t0, t1;
+	int i, rv = 0;
+
+	t0 = get_time();
+	for (i = 0; i < 10000; i++) {
+		rv |= snprintf(output, sizeof(output),
+			       "[%pT C%d: %s state %d] vbus %dmV ibus %dmA "
+			       "flags 0x%08x msg %ph\n",
+			       &ts, i & 1, "PE_SNK_Ready", 42 + (i & 7),
+			       5000 + i, -1500 - i, 0x80000000 | i,
+			       HEX_BUF(msg, sizeof(msg)));
+		ts += 1234;
+	}
+	t1 = get_time();
+	TEST_ASSERT(rv > 0);
+	ccprintf("10000 lines in %lld us\n", (long long)(t1.val - t0.val));
+
+	return EC_SUCCESS;
+}
+
 test_static int test_vsnprintf_combined(void)
 {
 	T(expect_success("abc",       "%c%s",    'a', "bc"));
@@ -309,6 +382,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_vsnprintf_timestamps);
 	RUN_TEST(test_vsnprintf_hexdump);
 	RUN_TEST(test_vsnprintf_combined);
+	RUN_TEST(test_vsnprintf_long_output);
+	RUN_TEST(test_vsnprintf_benchmark);
 
 	test_print_result();
 }
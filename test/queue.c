@@ -11,6 +11,8 @@
 #include "test_util.h"
 #include "timer.h"
 #include "util.h"
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 
 static struct queue const test_queue8 = QUEUE_NULL(8, char);
@@ -324,6 +326,55 @@ static int test_queue8_chunks_offset(void)
 	return EC_SUCCESS;
 }
 
+static int test_queue8_chunks_pair(void)
+{
+	static uint8_t const data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+	struct queue_chunk chunks[2];
+
+	/* An empty queue has nothing to read and one chunk to write */
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 0);
+	TEST_ASSERT(chunks[0].count == 0 && chunks[0].buffer == NULL);
+	TEST_ASSERT(chunks[1].count == 0 && chunks[1].buffer == NULL);
+
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 8);
+	TEST_ASSERT(chunks[0].count == 8);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer);
+	TEST_ASSERT(chunks[1].count == 0 && chunks[1].buffer == NULL);
+
+	/* Move near the end of the queue, free space now wraps */
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 6) == 6);
+	TEST_ASSERT(queue_advance_head(&test_queue8, 6) == 6);
+
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 8);
+	TEST_ASSERT(chunks[0].count == 2);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer + 6);
+	TEST_ASSERT(chunks[1].count == 6);
+	TEST_ASSERT(chunks[1].buffer == test_queue8.buffer);
+
+	/* Fill both halves in one go, as a DMA descriptor chain would */
+	memcpy(chunks[0].buffer, data, chunks[0].count);
+	memcpy(chunks[1].buffer, data + chunks[0].count, chunks[1].count);
+	TEST_ASSERT(queue_advance_tail(&test_queue8, 8) == 8);
+
+	TEST_ASSERT(queue_get_write_chunks(&test_queue8, chunks) == 0);
+	TEST_ASSERT(chunks[0].count == 0 && chunks[0].buffer == NULL);
+
+	/* And the data reads back across the wrap */
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 8);
+	TEST_ASSERT(chunks[0].count == 2);
+	TEST_ASSERT_ARRAY_EQ((uint8_t *) chunks[0].buffer, data, 2);
+	TEST_ASSERT(chunks[1].count == 6);
+	TEST_ASSERT_ARRAY_EQ((uint8_t *) chunks[1].buffer, data + 2, 6);
+
+	TEST_ASSERT(queue_advance_head(&test_queue8, 3) == 3);
+	TEST_ASSERT(queue_get_read_chunks(&test_queue8, chunks) == 5);
+	TEST_ASSERT(chunks[0].count == 5);
+	TEST_ASSERT(chunks[0].buffer == test_queue8.buffer + 1);
+	TEST_ASSERT(chunks[1].count == 0 && chunks[1].buffer == NULL);
+
+	return EC_SUCCESS;
+}
+
 static int test_queue8_iterate_begin(void)
 {
 	struct queue const *q = &test_queue8;
@@ -410,6 +461,173 @@ static int test_queue8_iterate_next_reset_on_change(void)
 	return EC_SUCCESS;
 }
 
+/*
+ * Concurrency stress: a producer and a consumer run on separate host threads
+ * and push a sequence of numbers through a small queue.  The consumer checks
+ * that every number arrives once, in order, and intact.
+ */
+#define STRESS_COUNT 50000
+#define STRESS_MAX_BURST 11
+
+enum stress_mode {
+	STRESS_UNIT,	/* queue_add_unit / queue_remove_unit */
+	STRESS_UNITS,	/* queue_add_units / queue_remove_units */
+	STRESS_CHUNKS,	/* queue_get_write_chunks / queue_get_read_chunks */
+};
+
+static struct queue const stress_queue = QUEUE_NULL(16, uint32_t);
+
+struct stress_side {
+	enum stress_mode mode;
+	int errors;
+	int stalls;
+};
+
+static size_t stress_burst(uint32_t *seed)
+{
+	*seed = prng(*seed);
+	return (*seed >> 16) % STRESS_MAX_BURST + 1;
+}
+
+/* Return the i'th unit described by a pair of chunks */
+static uint32_t *stress_unit(struct queue_chunk chunks[2], size_t i)
+{
+	if (i < chunks[0].count)
+		return (uint32_t *)chunks[0].buffer + i;
+	return (uint32_t *)chunks[1].buffer + (i - chunks[0].count);
+}
+
+static void *stress_producer(void *arg)
+{
+	struct stress_side *side = arg;
+	struct queue const *q = &stress_queue;
+	uint32_t seed = 0x1234;
+	uint32_t next = 0;
+
+	while (next < STRESS_COUNT) {
+		uint32_t buf[STRESS_MAX_BURST];
+		struct queue_chunk chunks[2];
+		size_t count = MIN(stress_burst(&seed), STRESS_COUNT - next);
+		size_t added = 0;
+		size_t i;
+
+		switch (side->mode) {
+		case STRESS_UNIT:
+			added = queue_add_unit(q, &next);
+			break;
+		case STRESS_UNITS:
+			for (i = 0; i < count; i++)
+				buf[i] = next + i;
+			added = queue_add_units(q, buf, count);
+			break;
+		case STRESS_CHUNKS:
+			count = MIN(count, queue_get_write_chunks(q, chunks));
+			for (i = 0; i < count; i++)
+				*stress_unit(chunks, i) = next + i;
+			added = queue_advance_tail(q, count);
+			break;
+		}
+
+		if (!added) {
+			side->stalls++;
+			sched_yield();
+		}
+		next += added;
+	}
+
+	return NULL;
+}
+
+static void *stress_consumer(void *arg)
+{
+	struct stress_side *side = arg;
+	struct queue const *q = &stress_queue;
+	uint32_t seed = 0x5678;
+	uint32_t expect = 0;
+
+	while (expect < STRESS_COUNT) {
+		uint32_t buf[STRESS_MAX_BURST];
+		struct queue_chunk chunks[2];
+		size_t count = stress_burst(&seed);
+		size_t removed = 0;
+		size_t i;
+
+		switch (side->mode) {
+		case STRESS_UNIT:
+			removed = queue_remove_unit(q, buf);
+			break;
+		case STRESS_UNITS:
+			removed = queue_remove_units(q, buf, count);
+			break;
+		case STRESS_CHUNKS:
+			count = MIN(count, queue_get_read_chunks(q, chunks));
+			for (i = 0; i < count; i++)
+				buf[i] = *stress_unit(chunks, i);
+			removed = queue_advance_head(q, count);
+			break;
+		}
+
+		if (!removed) {
+			side->stalls++;
+			sched_yield();
+		}
+		for (i = 0; i < removed; i++) {
+			if (buf[i] != expect)
+				side->errors++;
+			expect = buf[i] + 1;
+		}
+	}
+
+	return NULL;
+}
+
+static int run_stress(enum stress_mode producer_mode,
+		      enum stress_mode consumer_mode)
+{
+	struct stress_side producer = { .mode = producer_mode };
+	struct stress_side consumer = { .mode = consumer_mode };
+	pthread_t producer_thread, consumer_thread;
+
+	queue_init(&stress_queue);
+
+	TEST_ASSERT(pthread_create(&consumer_thread, NULL, stress_consumer,
+				   &consumer) == 0);
+	TEST_ASSERT(pthread_create(&producer_thread, NULL, stress_producer,
+				   &producer) == 0);
+	pthread_join(producer_thread, NULL);
+	pthread_join(consumer_thread, NULL);
+
+	ccprintf("Stress %d->%d: %d units, %d producer / %d consumer stalls\n",
+		 producer_mode, consumer_mode, STRESS_COUNT, producer.stalls,
+		 consumer.stalls);
+
+	TEST_EQ(consumer.errors, 0, "%d");
+	TEST_ASSERT(queue_is_empty(&stress_queue));
+
+	return EC_SUCCESS;
+}
+
+static int test_queue_stress_unit(void)
+{
+	return run_stress(STRESS_UNIT, STRESS_UNIT);
+}
+
+static int test_queue_stress_units(void)
+{
+	return run_stress(STRESS_UNITS, STRESS_UNITS);
+}
+
+static int test_queue_stress_chunks(void)
+{
+	return run_stress(STRESS_CHUNKS, STRESS_CHUNKS);
+}
+
+static int test_queue_stress_mixed(void)
+{
+	TEST_ASSERT(run_stress(STRESS_CHUNKS, STRESS_UNIT) == EC_SUCCESS);
+	return run_stress(STRESS_UNITS, STRESS_CHUNKS);
+}
+
 void before_test(void)
 {
 	queue_init(&test_queue2);
@@ -433,10 +651,15 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_queue8_chunks_empty);
 	RUN_TEST(test_queue8_chunks_advance);
 	RUN_TEST(test_queue8_chunks_offset);
+	RUN_TEST(test_queue8_chunks_pair);
 	RUN_TEST(test_queue8_iterate_begin);
 	RUN_TEST(test_queue8_iterate_next);
 	RUN_TEST(test_queue2_iterate_next_full);
 	RUN_TEST(test_queue8_iterate_next_reset_on_change);
+	RUN_TEST(test_queue_stress_unit);
+	RUN_TEST(test_queue_stress_units);
+	RUN_TEST(test_queue_stress_chunks);
+	RUN_TEST(test_queue_stress_mixed);
 
 	test_print_result();
 }
@@ -9,6 +9,7 @@
 #include "common.h"
 #include "rsa.h"
 #include "test_util.h"
+#include "timer.h"
 #include "util.h"
 
 #ifdef TEST_RSA3
@@ -19,6 +20,32 @@
 
 static uint32_t rsa_workbuf[3 * RSANUMBYTES/4];
 
+static uint8_t sig_big[RSANUMBYTES];
+
+static const uint8_t * const batch_sigs[] = { sig, sig, sig };
+static const uint8_t * const batch_hashes[] = { hash, hash_wrong, hash };
+
+#define BENCHMARK_LOOPS 20
+
+static void benchmark_verify(void)
+{
+	timestamp_t t0, t1;
+	int i;
+
+	t0 = get_time();
+	for (i = 0; i < BENCHMARK_LOOPS; i++)
+		rsa_verify(rsa_key, sig, hash, rsa_workbuf);
+	t1 = get_time();
+
+#ifdef CONFIG_RSA_EXPONENT_3
+	ccprintf("RSA-%d e=3: ", CONFIG_RSA_KEY_SIZE);
+#else
+	ccprintf("RSA-%d F4: ", CONFIG_RSA_KEY_SIZE);
+#endif
+	ccprintf("%d verifies in %lld us\n", BENCHMARK_LOOPS,
+		 (long long)(t1.val - t0.val));
+}
+
 void run_test(int argc, char **argv)
 {
 	int good;
@@ -49,6 +76,28 @@ void run_test(int argc, char **argv)
 	}
 	ccprintf("RSA verify FAILED (as expected)\n");
 
+	/* Test with a signature which is not less than the modulus */
+	memset(sig_big, 0xff, sizeof(sig_big));
+	good = rsa_verify(rsa_key, sig_big, hash, rsa_workbuf);
+	if (good) {
+		ccprintf("RSA verify OK (expected fail)\n");
+		test_fail();
+		return;
+	}
+	ccprintf("RSA verify FAILED (as expected)\n");
+
+	/* Batch verify reports each signature separately */
+	good = rsa_verify_batch(rsa_key, ARRAY_SIZE(batch_sigs), batch_sigs,
+				batch_hashes, rsa_workbuf);
+	if (good != (BIT(0) | BIT(2))) {
+		ccprintf("RSA batch verify got %x, expected 5\n", good);
+		test_fail();
+		return;
+	}
+	ccprintf("RSA batch verify OK\n");
+
+	benchmark_verify();
+
 	test_pass();
 }
 
@@ -15,7 +15,20 @@
 #include "link_defs.h"
 #include "shared_mem.h"
 #include "test_util.h"
+#include "timer.h"
 
+/*
+ * A good random number generator approximation. Guaranteed to generate the
+ * same sequence on all test runs.
+ */
+static uint32_t next = 127;
+static uint32_t myrand(void)
+{
+	next = next * 1103515245 + 12345;
+	return ((uint32_t)(next/65536) % 32768);
+}
+
+#ifndef CONFIG_MALLOC_SIZE_CLASSES
 /*
  * Total size of memory in the malloc pool (shared between free and allocated
  * buffers.
@@ -28,17 +41,6 @@ static int total_size;
  */
 static int counter = 500000;
 
-/*
- * A good random number generator approximation. Guaranteed to generate the
- * same sequence on all test runs.
- */
-static uint32_t next = 127;
-static uint32_t myrand(void)
-{
-	next = next * 1103515245 + 12345;
-	return ((uint32_t)(next/65536) % 32768);
-}
-
 /* Keep track of buffers allocated by the test function. */
 static struct {
 	void *buf;
@@ -207,7 +209,23 @@ static int shmem_is_ok(int line)
  */
 static uint32_t test_map;
 
-void run_test(int argc, char **argv)
+/* Release everything the path test still holds, checking as we go. */
+static int release_allocations(void)
+{
+	int index;
+
+	for (index = 0; index < ARRAY_SIZE(allocations); index++)
+		if (allocations[index].buf) {
+			shared_mem_release(allocations[index].buf);
+			allocations[index].buf = NULL;
+			if (!shmem_is_ok(__LINE__))
+				return EC_ERROR_UNKNOWN;
+		}
+
+	return EC_SUCCESS;
+}
+
+static int test_shmalloc_paths(void)
 {
 	int index;
 	const int shmem_size = shared_mem_size();
@@ -231,12 +249,10 @@ void run_test(int argc, char **argv)
 					 ", counter %d\n",
 					 test_map & ~ALL_PATHS_MASK,
 					 counter);
-				test_fail();
-				return;
+				return EC_ERROR_UNKNOWN;
 			}
 			ccprintf("Done testing, counter at %d\n", counter);
-			test_pass();
-			return;
+			return release_allocations();
 		}
 
 		/* Pick a random allocation entry. */
@@ -248,10 +264,8 @@ void run_test(int argc, char **argv)
 			 */
 			shared_mem_release(allocations[index].buf);
 			allocations[index].buf = 0;
-			if (!shmem_is_ok(__LINE__)) {
-				test_fail();
-				return;
-			}
+			if (!shmem_is_ok(__LINE__))
+				return EC_ERROR_UNKNOWN;
 		} else {
 			size_t alloc_size = r_data % (shmem_size);
 
@@ -272,10 +286,8 @@ void run_test(int argc, char **argv)
 					shptr[alloc_size] =
 					shptr[alloc_size] ^ 0xff;
 
-				if (!shmem_is_ok(__LINE__)) {
-					test_fail();
-					return;
-				}
+				if (!shmem_is_ok(__LINE__))
+					return EC_ERROR_UNKNOWN;
 			}
 		}
 	}
@@ -284,22 +296,134 @@ void run_test(int argc, char **argv)
 	 * The test is over, free all still allcated buffers, if any. Keep
 	 * verifying memory consistency after each free() invocation.
 	 */
-	for (index = 0; index < ARRAY_SIZE(allocations); index++)
-		if (allocations[index].buf) {
-			shared_mem_release(allocations[index].buf);
-			allocations[index].buf = NULL;
-			if (!shmem_is_ok(__LINE__)) {
-				test_fail();
-				return;
-			}
-		}
+	if (release_allocations() != EC_SUCCESS)
+		return EC_ERROR_UNKNOWN;
 
 	ccprintf("Did not pass all paths, map %x != %x\n",
 		 test_map, ALL_PATHS_MASK);
-	test_fail();
+	return EC_ERROR_UNKNOWN;
 }
 
 void set_map_bit(uint32_t mask)
 {
 	test_map |= mask;
 }
+#endif
+
+/*
+ * Randomized workload shared by the consistency test and the benchmark:
+ * mostly small, short lived buffers with the occasional large one, which is
+ * what vboot hashing, flash and USB updates do to shared memory.
+ */
+#define WORKLOAD_SLOTS 24
+
+static struct {
+	uint8_t *buf;
+	size_t size;
+	uint8_t fill;
+} slots[WORKLOAD_SLOTS];
+
+static size_t workload_size(uint32_t r_data, int shmem_size)
+{
+	if (r_data & 3)
+		return 16 + (r_data >> 2) % 496;
+	return (r_data >> 2) % (shmem_size / 4);
+}
+
+/*
+ * Run count random alloc/free operations, checking the contents of each
+ * buffer when it is freed.  Returns the number of failed allocations, or -1
+ * if a buffer got corrupted.
+ */
+static int run_workload(int count, int check)
+{
+	const int shmem_size = shared_mem_size();
+	int failed = 0;
+	int i, index;
+	size_t j;
+
+	for (i = 0; i < count; i++) {
+		uint32_t r_data = myrand() << 15 | myrand();
+
+		index = r_data % WORKLOAD_SLOTS;
+		r_data /= WORKLOAD_SLOTS;
+
+		if (slots[index].buf) {
+			for (j = 0; j < slots[index].size; j++)
+				if (slots[index].buf[j] !=
+				    (uint8_t)(slots[index].fill + j))
+					return -1;
+			shared_mem_release(slots[index].buf);
+			slots[index].buf = NULL;
+		} else {
+			slots[index].size = workload_size(r_data, shmem_size);
+			if (shared_mem_acquire(slots[index].size,
+					       (char **)&slots[index].buf) !=
+			    EC_SUCCESS) {
+				failed++;
+				continue;
+			}
+			slots[index].fill = r_data;
+			for (j = 0; j < slots[index].size; j++)
+				slots[index].buf[j] = slots[index].fill + j;
+		}
+
+#ifdef CONFIG_MALLOC_SIZE_CLASSES
+		if (check && shared_mem_check() != EC_SUCCESS) {
+			ccprintf("Heap inconsistent after op %d\n", i);
+			return -1;
+		}
+#endif
+	}
+
+	for (index = 0; index < WORKLOAD_SLOTS; index++) {
+		if (slots[index].buf)
+			shared_mem_release(slots[index].buf);
+		slots[index].buf = NULL;
+	}
+
+	return failed;
+}
+
+#ifdef CONFIG_MALLOC_SIZE_CLASSES
+static int test_shmalloc_consistency(void)
+{
+	const int shmem_size = shared_mem_size();
+
+	TEST_ASSERT(shared_mem_check() == EC_SUCCESS);
+	TEST_ASSERT(run_workload(20000, 1) >= 0);
+
+	/* Everything is free again, so it should all be one block */
+	TEST_ASSERT(shared_mem_check() == EC_SUCCESS);
+	TEST_EQ(shared_mem_size(), shmem_size, "%d");
+
+	return EC_SUCCESS;
+}
+#endif
+
+static int test_shmalloc_benchmark(void)
+{
+	timestamp_t t0 = get_time();
+	int failed = run_workload(200000, 0);
+	timestamp_t t1 = get_time();
+
+	TEST_ASSERT(failed >= 0);
+	ccprintf("Benchmark: 200000 ops, %d failed allocations, %lld us\n",
+		 failed, (long long)(t1.val - t0.val));
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+#ifdef CONFIG_MALLOC_SIZE_CLASSES
+	RUN_TEST(test_shmalloc_consistency);
+#else
+	RUN_TEST(test_shmalloc_paths);
+#endif
+	RUN_TEST(test_shmalloc_benchmark);
+
+	test_print_result();
+}
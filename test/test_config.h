@@ -11,9 +11,6 @@
 /* Test config flags only apply for test builds */
 #ifdef TEST_BUILD
 
-/* Host commands are sorted. */
-#define CONFIG_HOSTCMD_SECTION_SORTED
-
 /* Don't compile features unless specifically testing for them */
 #undef CONFIG_VBOOT_HASH
 #undef CONFIG_USB_PD_LOGGING
@@ -215,10 +212,23 @@ enum sensor_id {
 
 #endif
 
+#ifdef TEST_CONSOLE_EDIT
+#define CONFIG_CONSOLE_TAB_COMPLETION
+#endif
+
 #ifdef TEST_CRC32
 #define CONFIG_SW_CRC
 #endif
 
+#ifdef TEST_HOOKS
+#define CONFIG_HOOK_DEBUG
+#endif
+
+#ifdef TEST_HOST_COMMAND
+#define CONFIG_HOSTCMD_BATCH
+#define CONFIG_HOSTCMD_STATS
+#endif
+
 #ifdef TEST_RSA
 #define CONFIG_RSA
 #undef CONFIG_RSA_KEY_SIZE
@@ -248,6 +258,11 @@ enum sensor_id {
 #define CONFIG_MALLOC
 #endif
 
+#ifdef TEST_SHMALLOC_CLASSES
+#define CONFIG_MALLOC
+#define CONFIG_MALLOC_SIZE_CLASSES
+#endif
+
 #ifdef TEST_SBS_CHARGING_V2
 #define CONFIG_BATTERY
 #define CONFIG_BATTERY_MOCK
@@ -311,6 +326,10 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_ALS_LIGHTBAR_DIMMING 0
 #endif
 
+#ifdef TEST_UART_STATS
+#define CONFIG_CMD_UART_STATS
+#endif
+
 #ifdef TEST_USB_COMMON
 #define CONFIG_USB_POWER_DELIVERY
 #define CONFIG_USB_PD_TCPMV1
@@ -371,6 +390,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 
 #if defined(TEST_USB_PE_DRP_OLD)
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
+#define CONFIG_USB_PD_STATE_PROFILE
 #endif
 
 #define CONFIG_USB_PD_TCPMV2
@@ -384,7 +404,8 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USBC_SS_MUX
 #endif
 
-#if defined(TEST_USB_PE_DRP) || defined(TEST_USB_PE_DRP_NOEXTENDED)
+#if defined(TEST_USB_PE_DRP) || defined(TEST_USB_PE_DRP_NOEXTENDED) || \
+	defined(TEST_USB_PE_DRP_SHARED)
 #define CONFIG_TEST_USB_PE_SM
 #define CONFIG_USB_PD_PORT_MAX_COUNT 1
 #define CONFIG_USB_PE_SM
@@ -393,10 +414,14 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #undef CONFIG_USB_PRL_SM
 #define CONFIG_USB_PD_REV30
 
-#if defined(TEST_USB_PE_DRP)
+#if defined(TEST_USB_PE_DRP) || defined(TEST_USB_PE_DRP_SHARED)
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
 #endif
 
+#if defined(TEST_USB_PE_DRP_SHARED)
+#define CONFIG_USB_PD_SHARED_TASK
+#endif
+
 #define CONFIG_USB_PD_TCPMV2
 #define CONFIG_USB_PD_DECODE_SOP
 #undef CONFIG_USB_TYPEC_SM
@@ -444,13 +469,20 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_CTVPD
 #endif
 
-#ifdef TEST_USB_TYPEC_DRP_ACC_TRYSRC
+#if defined(TEST_USB_TYPEC_DRP_ACC_TRYSRC) || \
+	defined(TEST_USB_TYPEC_DRP_ACC_TRYSRC_SHARED) || \
+	defined(TEST_USB_PD_SHARED_TASK)
 #define CONFIG_USB_DRP_ACC_TRYSRC
 #define CONFIG_USB_PD_DUAL_ROLE
 #define CONFIG_USB_PD_TRY_SRC
 #define CONFIG_USB_TYPEC_SM
 #define CONFIG_USB_PD_TCPMV2
+#ifdef TEST_USB_PD_SHARED_TASK
+#define CONFIG_USB_PD_PORT_MAX_COUNT 2
+#define CONFIG_CMD_PD_STATS
+#else
 #define CONFIG_USB_PD_PORT_MAX_COUNT 1
+#endif
 #define CONFIG_USBC_SS_MUX
 #define CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
 #define CONFIG_USB_PD_VBUS_DETECT_TCPC
@@ -458,14 +490,21 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #undef CONFIG_USB_PRL_SM
 #undef CONFIG_USB_PE_SM
 #undef CONFIG_USB_PD_HOST_CMD
+#define CONFIG_USB_PD_STATE_PROFILE
+#if defined(TEST_USB_TYPEC_DRP_ACC_TRYSRC_SHARED) || \
+	defined(TEST_USB_PD_SHARED_TASK)
+#define CONFIG_USB_PD_SHARED_TASK
+#endif
 #endif
 
-#ifdef TEST_USB_TCPMV2_TCPCI
+#if defined(TEST_USB_TCPMV2_TCPCI) || \
+	defined(TEST_USB_TCPMV2_TCPCI_BLOCK_READ)
 #define CONFIG_USB_DRP_ACC_TRYSRC
 #define CONFIG_USB_PD_DUAL_ROLE
 #define CONFIG_USB_PD_DUAL_ROLE_AUTO_TOGGLE
 #define CONFIG_USB_PD_REV30
 #define CONFIG_USB_PD_TCPC_LOW_POWER
+#define CONFIG_USB_PD_TCPC_REG_CACHE
 #define CONFIG_USB_PD_TRY_SRC
 #define CONFIG_USB_PD_TCPMV2
 #define CONFIG_USB_PD_PORT_MAX_COUNT 1
@@ -485,6 +524,10 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_USB_PD_DEBUG_LEVEL 3
 #define CONFIG_USB_PD_EXTENDED_MESSAGES
 #define CONFIG_USB_PD_DECODE_SOP
+#define CONFIG_CMD_PD_STATS
+#ifdef TEST_USB_TCPMV2_TCPCI_BLOCK_READ
+#define CONFIG_CMD_TCPC_ALERT_STATS
+#endif
 #endif
 
 #ifdef TEST_USB_PD_INT
@@ -573,6 +616,11 @@ int ncp15wb_calculate_temp(uint16_t adc);
 					 CONFIG_RW_SIZE - CONFIG_RW_SIG_SIZE)
 #endif
 
+#ifdef TEST_VBOOT_HASH
+#define CONFIG_VBOOT_HASH
+#define CONFIG_VBOOT_HASH_CACHE 8
+#endif
+
 #ifdef TEST_X25519
 #define CONFIG_CURVE25519
 #endif /* TEST_X25519 */
@@ -19,6 +19,19 @@
 
 #define ERROR_MARGIN 5
 
+/* Stress phase: many tasks sleeping for short periods at the same time */
+#define STRESS_TIME SECOND
+#define STRESS_PERIOD_US(num) (((num % 16) + 1) * 100)
+#define STRESS_TASKS 8
+
+struct stress_stats {
+	int wakeups;
+	int early;
+	uint64_t late_total;
+	uint32_t late_max;
+};
+static struct stress_stats stress[STRESS_TASKS];
+
 static int calculate_golden(uint32_t seed)
 {
 	int golden = 0;
@@ -68,13 +81,88 @@ int task_timer(void *seed)
 	return EC_SUCCESS;
 }
 
+int task_sleeper(void *seed)
+{
+	uint32_t num = (uint32_t)(uintptr_t)seed;
+	struct stress_stats *st = &stress[task_get_current() - TASK_ID_SLPA];
+	timestamp_t start, deadline, now;
+	uint32_t late;
+
+	task_wait_event(-1);
+
+	start = get_time();
+	while (get_time().val - start.val < STRESS_TIME) {
+		deadline.val = get_time().val + STRESS_PERIOD_US(num);
+		usleep(STRESS_PERIOD_US(num));
+		now = get_time();
+
+		st->wakeups++;
+		if (now.val < deadline.val) {
+			st->early++;
+		} else {
+			late = now.val - deadline.val;
+			st->late_total += late;
+			st->late_max = MAX(st->late_max, late);
+		}
+		num = prng(num);
+	}
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Timer interrupt cost shows up as wake-up latency, so report how late the
+ * sleepers got woken up while they all had timers running.  The emulator's
+ * timer says nothing about real hardware, so only the count is shown there.
+ */
+static int stress_report(void)
+{
+	uint64_t late_total = 0;
+	uint32_t late_max = 0;
+	int wakeups = 0;
+	int early = 0;
+	int i;
+
+	for (i = 0; i < STRESS_TASKS; i++) {
+		wakeups += stress[i].wakeups;
+		early += stress[i].early;
+		late_total += stress[i].late_total;
+		late_max = MAX(late_max, stress[i].late_max);
+	}
+
+#ifdef EMU_BUILD
+	ccprintf("Stress: %d tasks, %d wakeups\n", STRESS_TASKS, wakeups);
+#else
+	ccprintf("Stress: %d tasks, %d wakeups, late avg %d us, max %d us\n",
+		 STRESS_TASKS, wakeups,
+		 wakeups ? (int)(late_total / wakeups) : 0, late_max);
+#endif
+
+	if (!wakeups || early) {
+		ccprintf("%d of %d sleeps ended early!\n", early, wakeups);
+		return EC_ERROR_UNKNOWN;
+	}
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, char **argv)
 {
+	int i;
+
 	wait_for_task_started();
 	task_wake(TASK_ID_TMRD);
 	task_wake(TASK_ID_TMRC);
 	task_wake(TASK_ID_TMRB);
 	task_wake(TASK_ID_TMRA);
 	usleep(TEST_TIME + SECOND);
-	test_pass();
+
+	for (i = 0; i < STRESS_TASKS; i++)
+		task_wake(TASK_ID_SLPA + i);
+	usleep(STRESS_TIME + SECOND);
+
+	if (stress_report() != EC_SUCCESS)
+		test_fail();
+	else
+		test_pass();
 }
@@ -0,0 +1,72 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for the UART transmit statistics.
+ */
+
+#include "common.h"
+#include "task.h"
+#include "test_util.h"
+#include "uart.h"
+#include "util.h"
+
+extern uint32_t tx_stats_bytes;
+extern uint32_t tx_stats_interrupts;
+
+static const char msg[] = "uart stats\n";
+/* The '\n' goes out as "\r\n" */
+#define MSG_BYTES (sizeof(msg) - 1 + 1)
+
+static void reset_stats(void)
+{
+	uart_flush_output();
+	tx_stats_bytes = 0;
+	tx_stats_interrupts = 0;
+}
+
+static int test_task_output(void)
+{
+	reset_stats();
+	uart_puts(msg);
+	uart_flush_output();
+
+	TEST_ASSERT(tx_stats_bytes == MSG_BYTES);
+	TEST_ASSERT(tx_stats_interrupts >= 1);
+	TEST_ASSERT(tx_stats_interrupts <= MSG_BYTES);
+
+	return EC_SUCCESS;
+}
+
+static void flush_isr(void)
+{
+	uart_flush_output();
+}
+
+static int test_flush_from_interrupt(void)
+{
+	reset_stats();
+
+	/* Queue output without kicking the UART interrupt */
+	interrupt_disable();
+	uart_puts(msg);
+	interrupt_enable();
+	TEST_ASSERT(tx_stats_bytes == 0);
+
+	/* Flushing from another interrupt isn't a UART interrupt */
+	task_trigger_test_interrupt(flush_isr);
+	TEST_ASSERT(tx_stats_bytes == MSG_BYTES);
+	TEST_ASSERT(tx_stats_interrupts == 0);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_task_output);
+	RUN_TEST(test_flush_from_interrupt);
+
+	test_print_result();
+}
@@ -0,0 +1,136 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test that the shared PD task only runs the ports which have events.
+ */
+#include "charge_manager.h"
+#include "mock/tcpc_mock.h"
+#include "mock/usb_mux_mock.h"
+#include "task.h"
+#include "test_util.h"
+#include "timer.h"
+#include "usb_mux.h"
+#include "usb_pd.h"
+#include "usb_pd_tcpm.h"
+#include "usb_tc_sm.h"
+
+#define PORT0 0
+#define PORT1 1
+
+/* TODO(b/153071799): Move these pd_* and pe_* function into mock */
+__overridable void pd_request_power_swap(int port)
+{}
+
+uint8_t pd_get_src_cap_cnt(int port)
+{
+	return 0;
+}
+
+const uint32_t * const pd_get_src_caps(int port)
+{
+	return NULL;
+}
+
+void pd_set_src_caps(int port, int cnt, uint32_t *src_caps)
+{
+}
+
+__overridable void pe_invalidate_explicit_contract(int port)
+{
+}
+/* End pd_ mock section */
+
+/* Both ports share the mock TCPC, so both see an open port */
+const struct tcpc_config_t tcpc_config[CONFIG_USB_PD_PORT_MAX_COUNT] = {
+	{
+		.drv = &mock_tcpc_driver,
+	},
+	{
+		.drv = &mock_tcpc_driver,
+	},
+};
+
+const struct usb_mux usb_muxes[CONFIG_USB_PD_PORT_MAX_COUNT] = {
+	{
+		.driver = &mock_usb_mux_driver,
+	},
+	{
+		.driver = &mock_usb_mux_driver,
+	},
+};
+
+void charge_manager_set_ceil(int port, enum ceil_requestor requestor, int ceil)
+{
+	/* Do Nothing, but needed for linking */
+}
+
+extern uint32_t pd_wakeups[];
+extern uint32_t pd_timer_wakeups[];
+
+/* Wakeups of a port for events, rather than for its own deadlines */
+static uint32_t event_wakeups(int port)
+{
+	return pd_wakeups[port] - pd_timer_wakeups[port];
+}
+
+static int check_event_runs_one_port(int port, int other)
+{
+	uint32_t port_wakeups = event_wakeups(port);
+	uint32_t other_wakeups = event_wakeups(other);
+
+	pd_task_set_event(port, PD_EVENT_CC);
+	task_wait_event(10 * MSEC);
+
+	TEST_EQ(event_wakeups(port), port_wakeups + 1, "%d");
+	TEST_EQ(event_wakeups(other), other_wakeups, "%d");
+
+	return EC_SUCCESS;
+}
+
+__maybe_unused static int test_event_for_port1(void)
+{
+	return check_event_runs_one_port(PORT1, PORT0);
+}
+
+__maybe_unused static int test_event_for_port0(void)
+{
+	return check_event_runs_one_port(PORT0, PORT1);
+}
+
+__maybe_unused static int test_task_event_runs_all_ports(void)
+{
+	uint32_t port0_wakeups = event_wakeups(PORT0);
+	uint32_t port1_wakeups = event_wakeups(PORT1);
+
+	/* Events set on the task itself aren't tied to one port */
+	task_wake(TASK_ID_PD_C0);
+	task_wait_event(10 * MSEC);
+
+	TEST_EQ(event_wakeups(PORT0), port0_wakeups + 1, "%d");
+	TEST_EQ(event_wakeups(PORT1), port1_wakeups + 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Reset the mocks before each test */
+void before_test(void)
+{
+	mock_usb_mux_reset();
+	mock_tcpc_reset();
+
+	/* Restart the PD task and let both ports settle */
+	task_set_event(TASK_ID_PD_C0, TASK_EVENT_RESET_DONE, 0);
+	task_wait_event(SECOND);
+}
+
+void run_test(int argc, char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_event_for_port1);
+	RUN_TEST(test_event_for_port0);
+	RUN_TEST(test_task_event_runs_all_ports);
+
+	test_print_result();
+}
@@ -53,6 +53,7 @@ uint8_t tc_get_pd_enabled(int port)
 void pd_comm_enable(int port, int enable)
 {
 	tc_enabled = !!enable;
+	task_wake(PD_PORT_TO_TASK_ID(port));
 }
 
 bool pd_alt_mode_capable(int port)
@@ -91,7 +91,11 @@ const struct tcpc_config_t tcpc_config[CONFIG_USB_PD_PORT_MAX_COUNT] = {
 			.addr_flags = MOCK_TCPCI_I2C_ADDR_FLAGS,
 		},
 		.drv = &tcpci_tcpm_drv,
+#ifdef TEST_USB_TCPMV2_TCPCI_BLOCK_READ
+		.flags = TCPC_FLAGS_TCPCI_REV2_0 | TCPC_FLAGS_BLOCK_READ,
+#else
 		.flags = TCPC_FLAGS_TCPCI_REV2_0,
+#endif
 	},
 };
 
@@ -365,6 +369,55 @@ __maybe_unused static int test_pd3_source_send_soft_reset(void)
 	return EC_SUCCESS;
 }
 
+extern uint32_t pd_wakeups[];
+extern uint32_t pd_timer_wakeups[];
+
+__maybe_unused static int test_attached_idle_wakeups(void)
+{
+	TEST_EQ(test_connect_as_pd3_source(), EC_SUCCESS, "%d");
+
+	pd_wakeups[PORT0] = 0;
+	pd_timer_wakeups[PORT0] = 0;
+	task_wait_event(10 * SECOND);
+	ccprints("idle wakeups %d, on timer %d", pd_wakeups[PORT0],
+		 pd_timer_wakeups[PORT0]);
+
+	/*
+	 * A settled port wakes for its timers, and at least every 40 ms, so
+	 * about 250 times.  Polling every 5 ms would be 2000 wakeups.
+	 */
+	TEST_LE(pd_wakeups[PORT0], 275, "%d");
+	TEST_EQ(tc_is_attached_src(PORT0), true, "%d");
+
+	return EC_SUCCESS;
+}
+
+__maybe_unused static int test_fault_forgets_power_ctrl(void)
+{
+	TEST_EQ(test_connect_as_pd3_source(), EC_SUCCESS, "%d");
+
+	/* Cache POWER_CONTROL with VCONN on */
+	TEST_EQ(tcpci_tcpm_set_vconn(PORT0, 1), EC_SUCCESS, "%d");
+	TEST_NE(TCPC_REG_POWER_CTRL_VCONN(
+			mock_tcpci_get_reg(TCPC_REG_POWER_CTRL)), 0, "%d");
+
+	/* The TCPC turns VCONN off on its own for an over-current fault */
+	mock_tcpci_set_reg(TCPC_REG_POWER_CTRL,
+			   mock_tcpci_get_reg(TCPC_REG_POWER_CTRL) &
+			   ~TCPC_REG_POWER_CTRL_VCONN(1));
+	mock_tcpci_set_reg(TCPC_REG_FAULT_STATUS,
+			   TCPC_REG_FAULT_STATUS_VCONN_OVER_CURRENT);
+	mock_set_alert(TCPC_REG_ALERT_FAULT);
+	task_wait_event(10 * MSEC);
+
+	/* Updating another bit must not turn VCONN back on */
+	tcpci_tcpc_enable_auto_discharge_disconnect(PORT0, 1);
+	TEST_EQ(TCPC_REG_POWER_CTRL_VCONN(
+			mock_tcpci_get_reg(TCPC_REG_POWER_CTRL)), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	rx_id = 0;
@@ -387,6 +440,8 @@ void run_test(int argc, char **argv)
 	RUN_TEST(test_retry_count_sop);
 	RUN_TEST(test_retry_count_hard_reset);
 	RUN_TEST(test_pd3_source_send_soft_reset);
+	RUN_TEST(test_attached_idle_wakeups);
+	RUN_TEST(test_fault_forgets_power_ctrl);
 
 	test_print_result();
 }
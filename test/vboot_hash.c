@@ -0,0 +1,209 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests for vboot hash computing.
+ */
+
+#include "common.h"
+#include "ec_commands.h"
+#include "flash.h"
+#include "host_command.h"
+#include "sha256.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+#include "vboot_hash.h"
+
+#define HASH_OFFSET CONFIG_EC_WRITABLE_STORAGE_OFF
+#define HASH_SIZE 0x8000
+/* Size of each cached region of the data */
+#define REGION_SIZE (HASH_SIZE / CONFIG_VBOOT_HASH_CACHE)
+
+extern uint32_t curr_pos;
+extern uint32_t resume_pos;
+
+static uint8_t data[HASH_SIZE];
+
+static int hash_command(uint8_t cmd, const uint8_t *nonce, int nonce_size,
+			struct ec_response_vboot_hash *r)
+{
+	struct ec_params_vboot_hash p = {
+		.cmd = cmd,
+		.hash_type = EC_VBOOT_HASH_TYPE_SHA256,
+		.nonce_size = nonce_size,
+		.offset = HASH_OFFSET,
+		.size = HASH_SIZE,
+	};
+
+	memcpy(p.nonce_data, nonce, nonce_size);
+	return test_send_host_command(EC_CMD_VBOOT_HASH, 0, &p, sizeof(p),
+				      r, sizeof(*r));
+}
+
+/* Check that a recalculated hash is the plain SHA256 of the flash data */
+static int check_hash(const uint8_t *nonce, int nonce_size)
+{
+	struct ec_response_vboot_hash r;
+	struct sha256_ctx ctx;
+
+	TEST_ASSERT(flash_read(HASH_OFFSET, HASH_SIZE, data) == EC_SUCCESS);
+	SHA256_init(&ctx);
+	SHA256_update(&ctx, nonce, nonce_size);
+	SHA256_update(&ctx, data, HASH_SIZE);
+	SHA256_final(&ctx);
+
+	TEST_ASSERT(hash_command(EC_VBOOT_HASH_RECALC, nonce, nonce_size, &r) ==
+		    EC_RES_SUCCESS);
+	TEST_ASSERT(r.status == EC_VBOOT_HASH_STATUS_DONE);
+	TEST_ASSERT(r.offset == HASH_OFFSET);
+	TEST_ASSERT(r.size == HASH_SIZE);
+	TEST_ASSERT_ARRAY_EQ(r.hash_digest, ctx.buf, SHA256_DIGEST_SIZE);
+
+	return EC_SUCCESS;
+}
+
+static int write_pattern(int offset, int size, uint8_t seed)
+{
+	uint8_t buf[64];
+	int i;
+
+	for (i = 0; i < sizeof(buf); i++)
+		buf[i] = seed + i * 7;
+	TEST_ASSERT(size <= sizeof(buf));
+
+	return flash_write(offset, size, (const char *)buf);
+}
+
+static int test_full_hash(void)
+{
+	int i;
+
+	for (i = 0; i < HASH_SIZE; i += 64)
+		TEST_ASSERT(write_pattern(HASH_OFFSET + i, 64, i) ==
+			    EC_SUCCESS);
+
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_resume_after_write(void)
+{
+	/* Nothing changed, so only the last region is hashed again */
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == HASH_SIZE - REGION_SIZE);
+
+	/* Write to the middle of region 5 */
+	TEST_ASSERT(write_pattern(HASH_OFFSET + 5 * REGION_SIZE + 0x100, 16,
+				  0x55) == EC_SUCCESS);
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 5 * REGION_SIZE);
+
+	/* Two writes only rehash from the lower one */
+	TEST_ASSERT(write_pattern(HASH_OFFSET + 6 * REGION_SIZE, 2, 0x66) ==
+		    EC_SUCCESS);
+	TEST_ASSERT(write_pattern(HASH_OFFSET + 2 * REGION_SIZE - 2, 4,
+				  0x22) == EC_SUCCESS);
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == REGION_SIZE);
+
+	return EC_SUCCESS;
+}
+
+static int test_write_outside(void)
+{
+	/* Writes after the data keep the cache */
+	TEST_ASSERT(write_pattern(HASH_OFFSET + HASH_SIZE, 16, 0x11) ==
+		    EC_SUCCESS);
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == HASH_SIZE - REGION_SIZE);
+
+	/* Writes overlapping the start rehash everything */
+	TEST_ASSERT(write_pattern(HASH_OFFSET - 8, 16, 0x88) == EC_SUCCESS);
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 0);
+
+	return EC_SUCCESS;
+}
+
+static int test_write_between_chunks(void)
+{
+	struct ec_response_vboot_hash r;
+	uint32_t pos;
+
+	/* Rehash everything, and stop partway through region 3 */
+	TEST_ASSERT(write_pattern(HASH_OFFSET, 16, 0x33) == EC_SUCCESS);
+	TEST_ASSERT(hash_command(EC_VBOOT_HASH_START, NULL, 0, &r) ==
+		    EC_RES_SUCCESS);
+	while (curr_pos < 3 * REGION_SIZE + REGION_SIZE / 2)
+		usleep(10);
+	pos = curr_pos;
+	TEST_ASSERT(vboot_hash_in_progress());
+	TEST_ASSERT(pos / REGION_SIZE == 3 && pos % REGION_SIZE);
+
+	/* Change data which has already been hashed */
+	TEST_ASSERT(write_pattern(HASH_OFFSET + pos - 16, 16, 0x44) ==
+		    EC_SUCCESS);
+	while (vboot_hash_in_progress())
+		usleep(10);
+
+	/* The states saved before region 3 are still good, later ones not */
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 3 * REGION_SIZE);
+
+	/* And the recalculated states are good too */
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == HASH_SIZE - REGION_SIZE);
+
+	return EC_SUCCESS;
+}
+
+static int test_physical_write(void)
+{
+	const char buf[16] = { 0x77 };
+	const int offset = HASH_OFFSET + 4 * REGION_SIZE + 0x40;
+
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == HASH_SIZE - REGION_SIZE);
+
+	/* Write the way update_fw.c and usb_pd_policy.c do */
+	vboot_hash_cache_invalidate(offset, sizeof(buf));
+	TEST_ASSERT(flash_physical_write(offset, sizeof(buf), buf) ==
+		    EC_SUCCESS);
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 4 * REGION_SIZE);
+
+	return EC_SUCCESS;
+}
+
+static int test_nonce(void)
+{
+	const uint8_t nonce[] = { 0xde, 0xad, 0xbe, 0xef, 0x01 };
+
+	/* A hash with a nonce can't use the cache, nor replace it */
+	TEST_ASSERT(check_hash(nonce, sizeof(nonce)) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == 0);
+
+	TEST_ASSERT(check_hash(NULL, 0) == EC_SUCCESS);
+	TEST_ASSERT(resume_pos == HASH_SIZE - REGION_SIZE);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, char **argv)
+{
+	/* Let the hash started at init finish */
+	while (vboot_hash_in_progress())
+		msleep(10);
+
+	RUN_TEST(test_full_hash);
+	RUN_TEST(test_resume_after_write);
+	RUN_TEST(test_write_outside);
+	RUN_TEST(test_write_between_chunks);
+	RUN_TEST(test_physical_write);
+	RUN_TEST(test_nonce);
+
+	test_print_result();
+}
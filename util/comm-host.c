@@ -83,6 +83,83 @@ int ec_command(int command, int version,
 				indata, insize);
 }
 
+int ec_command_batch(struct ec_batch_cmd *cmds, int count, int flags)
+{
+	struct ec_params_batch *p;
+	struct ec_response_batch *r;
+	uint8_t *out, *in, *in_end;
+	int outsize = sizeof(*p);
+	int i, rv;
+
+	if (count <= 0 || count > UINT8_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++)
+		outsize += sizeof(struct ec_batch_request) +
+			((cmds[i].outsize + 3) & ~3);
+	if (outsize > ec_max_outsize)
+		return -EINVAL;
+
+	p = calloc(1, outsize);
+	r = malloc(ec_max_insize);
+	if (!p || !r) {
+		rv = -ENOMEM;
+		goto out;
+	}
+
+	p->count = count;
+	p->flags = flags;
+	out = (uint8_t *)(p + 1);
+	for (i = 0; i < count; i++) {
+		struct ec_batch_request *req = (struct ec_batch_request *)out;
+
+		req->command = command_offset + cmds[i].command;
+		req->command_version = cmds[i].version;
+		req->data_len = cmds[i].outsize;
+		if (cmds[i].outsize)
+			memcpy(req + 1, cmds[i].outdata, cmds[i].outsize);
+		out += sizeof(*req) + ((cmds[i].outsize + 3) & ~3);
+	}
+
+	/* The batch itself already carries the offset in each sub-request */
+	rv = ec_command_proto(EC_CMD_BATCH, 0, p, outsize, r, ec_max_insize);
+	if (rv < 0)
+		goto out;
+	if (rv < (int)sizeof(*r) || r->count > count) {
+		rv = -EC_RES_INVALID_RESPONSE;
+		goto out;
+	}
+
+	in = (uint8_t *)(r + 1);
+	in_end = (uint8_t *)r + rv;
+	for (i = 0; i < r->count; i++) {
+		struct ec_batch_response *resp = (struct ec_batch_response *)in;
+
+		if (in_end - in < (int)sizeof(*resp) ||
+		    in_end - in - (int)sizeof(*resp) < resp->data_len) {
+			rv = -EC_RES_INVALID_RESPONSE;
+			goto out;
+		}
+
+		cmds[i].result = resp->result;
+		cmds[i].resp_size = resp->data_len;
+		if (cmds[i].resp_size > cmds[i].insize)
+			cmds[i].resp_size = cmds[i].insize;
+		if (cmds[i].resp_size)
+			memcpy(cmds[i].indata, resp + 1, cmds[i].resp_size);
+
+		in += sizeof(*resp) + ((resp->data_len + 3) & ~3);
+		if (in > in_end)
+			in = in_end;
+	}
+	rv = r->count;
+
+out:
+	free(p);
+	free(r);
+	return rv;
+}
+
 int comm_init_alt(int interfaces, const char *device_name, int i2c_bus)
 {
 	bool dev_is_cros_ec;
@@ -66,6 +66,32 @@ int ec_command(int command, int version,
 	       const void *outdata, int outsize,   /* to the EC */
 	       void *indata, int insize);	   /* from the EC */
 
+/* One sub-command of an ec_command_batch() call */
+struct ec_batch_cmd {
+	int command;
+	int version;
+	const void *outdata;	/* to the EC */
+	int outsize;
+	void *indata;		/* from the EC */
+	int insize;
+	int result;		/* Filled in: EC_RES_* for this command */
+	int resp_size;		/* Filled in: bytes of indata returned */
+};
+
+/**
+ * Send several commands to the EC in a single EC_CMD_BATCH packet.
+ *
+ * Each command gets its own result; see EC_CMD_BATCH for which commands are
+ * run when the response fills up or a command fails.
+ *
+ * @param cmds		Commands to run, in order
+ * @param count		Number of commands
+ * @param flags		EC_BATCH_FLAG_* for the request
+ * @return the number of commands the EC ran (their result and resp_size are
+ * valid), or negative on error.
+ */
+int ec_command_batch(struct ec_batch_cmd *cmds, int count, int flags);
+
 /**
  * Set the offset to be applied to the command number when ec_command() calls
  * ec_command_proto().
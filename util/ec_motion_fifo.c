@@ -0,0 +1,165 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Reference decoder for the packed motion sense FIFO format.
+ */
+
+#include <string.h>
+
+#include "ec_motion_fifo.h"
+
+/* Earlier values in the response, see struct fifo_pack_state in the EC. */
+struct unpack_state {
+	uint32_t timestamp;
+	uint32_t sampled;
+	uint32_t sample_ts[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE];
+	uint32_t interval[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE];
+	int16_t data[MOTIONSENSE_FIFO_PACKED_SENSOR_NONE][3];
+};
+
+struct unpack_input {
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+};
+
+static int get_varint(struct unpack_input *in, uint32_t *v)
+{
+	int shift;
+
+	*v = 0;
+	for (shift = 0; shift < 35; shift += 7) {
+		if (in->pos >= in->size)
+			return -1;
+		*v |= (uint32_t)(in->data[in->pos] & 0x7f) << shift;
+		if (!(in->data[in->pos++] & 0x80))
+			return 0;
+	}
+	return -1;
+}
+
+static int get_signed(struct unpack_input *in, int32_t *v)
+{
+	uint32_t u;
+
+	if (get_varint(in, &u))
+		return -1;
+	*v = (int32_t)((u >> 1) ^ -(u & 1));
+	return 0;
+}
+
+static int get_xyz(struct unpack_state *state, struct unpack_input *in,
+		   uint8_t sensor, struct ec_response_motion_sensor_data *out)
+{
+	int32_t delta;
+	int i;
+
+	out->sensor_num = sensor;
+	for (i = 0; i < 3; i++) {
+		if (get_signed(in, &delta))
+			return -1;
+		state->data[sensor][i] += delta;
+		out->data[i] = state->data[sensor][i];
+	}
+	return 0;
+}
+
+/*
+ * Unpacks one packed entry into out, which has room for out_count entries.
+ * Returns the number of entries unpacked, or -1 on error.
+ */
+static int unpack_entry(struct unpack_state *state, struct unpack_input *in,
+			struct ec_response_motion_sensor_data *out,
+			int out_count)
+{
+	uint8_t header, sensor, tablet = 0;
+	uint32_t predicted;
+	int32_t delta;
+
+	if (in->pos >= in->size || out_count < 1)
+		return -1;
+	header = in->data[in->pos++];
+	sensor = header & MOTIONSENSE_FIFO_PACKED_SENSOR_MASK;
+
+	memset(out, 0, sizeof(*out));
+	if (header & MOTIONSENSE_FIFO_PACKED_TABLET_MODE)
+		tablet = MOTIONSENSE_SENSOR_FLAG_TABLET_MODE;
+	out->flags = tablet;
+	if (header & MOTIONSENSE_FIFO_PACKED_WAKEUP)
+		out->flags |= MOTIONSENSE_SENSOR_FLAG_WAKEUP;
+
+	switch ((header & MOTIONSENSE_FIFO_PACKED_TYPE_MASK) >>
+		MOTIONSENSE_FIFO_PACKED_TYPE_SHIFT) {
+	case MOTIONSENSE_FIFO_PACKED_DATA:
+		if (sensor == MOTIONSENSE_FIFO_PACKED_SENSOR_NONE ||
+		    get_xyz(state, in, sensor, out))
+			return -1;
+		return 1;
+	case MOTIONSENSE_FIFO_PACKED_TIMESTAMP:
+		out->flags |= MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
+		out->sensor_num = sensor == MOTIONSENSE_FIFO_PACKED_SENSOR_NONE ?
+			0xff : sensor;
+		if (get_signed(in, &delta))
+			return -1;
+		state->timestamp += delta;
+		out->timestamp = state->timestamp;
+		return 1;
+	case MOTIONSENSE_FIFO_PACKED_RAW:
+		if (in->pos + sizeof(*out) > in->size)
+			return -1;
+		memcpy(out, in->data + in->pos, sizeof(*out));
+		in->pos += sizeof(*out);
+		return 1;
+	case MOTIONSENSE_FIFO_PACKED_SAMPLE:
+		if (sensor == MOTIONSENSE_FIFO_PACKED_SENSOR_NONE ||
+		    out_count < 2 || get_signed(in, &delta))
+			return -1;
+		if (state->sampled & (1 << sensor))
+			predicted = state->sample_ts[sensor] +
+				state->interval[sensor];
+		else
+			predicted = state->timestamp;
+		/* The timestamp comes first, the header flags go with data. */
+		out[1] = out[0];
+		if (get_xyz(state, in, sensor, &out[1]))
+			return -1;
+		out[0].flags = tablet | MOTIONSENSE_SENSOR_FLAG_TIMESTAMP;
+		out[0].sensor_num = sensor;
+		out[0].timestamp = predicted + delta;
+		state->interval[sensor] = state->sampled & (1 << sensor) ?
+			out[0].timestamp - state->sample_ts[sensor] : 0;
+		state->sampled |= 1 << sensor;
+		state->sample_ts[sensor] = out[0].timestamp;
+		state->timestamp = out[0].timestamp;
+		return 2;
+	default:
+		return -1;
+	}
+}
+
+int ec_motion_fifo_unpack(const uint8_t *in, size_t in_size, int count,
+			  struct ec_response_motion_sensor_data *out,
+			  int out_count)
+{
+	struct unpack_state state;
+	struct unpack_input input = {
+		.data = in,
+		.size = in_size,
+	};
+	int i = 0;
+	int n;
+
+	if (count > out_count)
+		return -1;
+
+	memset(&state, 0, sizeof(state));
+	while (i < count) {
+		n = unpack_entry(&state, &input, out + i, count - i);
+		if (n < 0)
+			return -1;
+		i += n;
+	}
+
+	return count;
+}
@@ -0,0 +1,29 @@
+/* Copyright 2020 The Chromium OS Authors. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef EC_MOTION_FIFO_H
+#define EC_MOTION_FIFO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ec_commands.h"
+
+/**
+ * Unpacks the data of a packed motion sense FIFO read, see
+ * struct ec_response_motion_sense_fifo_packed.
+ *
+ * @param in        Packed entries, the data field of the response
+ * @param in_size   Size of the packed entries in bytes
+ * @param count     Number of packed entries, number_data in the response
+ * @param out       Where to store the unpacked entries
+ * @param out_count Number of entries out can hold
+ * @return the number of entries unpacked, or -1 if the data is malformed.
+ */
+int ec_motion_fifo_unpack(const uint8_t *in, size_t in_size, int count,
+			  struct ec_response_motion_sensor_data *out,
+			  int out_count);
+
+#endif /* EC_MOTION_FIFO_H */
@@ -21,6 +21,7 @@
 #include "chipset.h"
 #include "compile_time_macros.h"
 #include "cros_ec_dev.h"
+#include "ec_motion_fifo.h"
 #include "ec_panicinfo.h"
 #include "ec_flash.h"
 #include "ec_version.h"
@@ -72,6 +73,8 @@ const char help_str[] =
 	"      Turn on automatic fan speed control.\n"
 	"  backlight <enabled>\n"
 	"      Enable/disable LCD backlight\n"
+	"  batch <cmd>[.<ver>] [<cmd>[.<ver>]...]\n"
+	"      Runs commands without params in one packet, prints responses\n"
 	"  battery\n"
 	"      Prints battery info\n"
 	"  batterycutoff [at-shutdown]\n"
@@ -166,6 +169,8 @@ const char help_str[] =
 	"      Set the value of GPIO signal\n"
 	"  hangdetect <flags> <event_msec> <reboot_msec> | stop | start\n"
 	"      Configure or start/stop the hang detect timer\n"
+	"  hcstats [reset]\n"
+	"      Prints (or clears) host command handler statistics\n"
 	"  hello\n"
 	"      Checks for basic communication with EC\n"
 	"  hibdelay [sec]\n"
@@ -553,6 +558,57 @@ int cmd_hibdelay(int argc, char *argv[])
 	return 0;
 }
 
+int cmd_hcstats(int argc, char *argv[])
+{
+	struct ec_params_hostcmd_stats p = { .index = 0 };
+	struct ec_response_hostcmd_stats *r = ec_inbuf;
+	const struct ec_hostcmd_stats_entry *e;
+	int rv, i, j;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "reset")) {
+			fprintf(stderr, "Usage: %s [reset]\n", argv[0]);
+			return -1;
+		}
+		p.flags = EC_HOSTCMD_STATS_FLAG_RESET;
+	}
+
+	if (!p.flags)
+		printf("Cmd       Count   Avg us   Max us  Histogram\n");
+
+	do {
+		rv = ec_command(EC_CMD_HOSTCMD_STATS, 0, &p, sizeof(p),
+				ec_inbuf, ec_max_insize);
+		if (rv < 0) {
+			fprintf(stderr, "err: rv=%d\n", rv);
+			return rv;
+		}
+		if (rv < sizeof(*r) || rv < sizeof(*r) + r->count * sizeof(*e)) {
+			fprintf(stderr, "Bad response size %d\n", rv);
+			return -1;
+		}
+
+		for (i = 0; i < r->count; i++) {
+			e = r->entries + i;
+			printf("0x%04x %8u %8u %8u ", e->command, e->count,
+			       e->total_us / e->count, e->max_us);
+			/* Bucket n counts calls under 2^(n+1) us */
+			for (j = 0; j < EC_HOSTCMD_STATS_BUCKETS - 1; j++)
+				if (e->histogram[j])
+					printf(" <%uus:%u", 2u << j,
+					       e->histogram[j]);
+			if (e->histogram[j])
+				printf(" >=%uus:%u", 1u << j, e->histogram[j]);
+			printf("\n");
+		}
+
+		p.index = r->next_index;
+		p.flags = 0;
+	} while (p.index);
+
+	return 0;
+}
+
 static int get_latest_cmd_version(uint8_t cmd, int *version)
 {
 	struct ec_params_get_cmd_versions p;
@@ -5364,7 +5420,13 @@ static int cmd_motionsense(int argc, char **argv)
 		} fifo_read_buffer = {
 			.number_data = -1,
 		};
+		struct {
+			uint32_t number_data;
+			uint8_t data[512 * MOTIONSENSE_FIFO_PACKED_MAX_ENTRY];
+		} packed_buffer;
 		int print_data = 0,  max_data = strtol(argv[2], &e, 0);
+		int packed = ec_cmd_version_supported(EC_CMD_MOTION_SENSE_CMD,
+						      5);
 
 		if (e && *e) {
 			fprintf(stderr, "Bad %s arg.\n", argv[2]);
@@ -5378,12 +5440,37 @@ static int cmd_motionsense(int argc, char **argv)
 				MIN(ARRAY_SIZE(fifo_read_buffer.data),
 				    max_data - print_data);
 
-			rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 2,
+			if (packed) {
+				rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 5,
+					&param,
+					ms_command_sizes[param.cmd].outsize,
+					&packed_buffer, ec_max_insize);
+				if (rv < 0)
+					return rv;
+				if (rv < sizeof(packed_buffer.number_data)) {
+					fprintf(stderr,
+						"Short packed fifo read.\n");
+					return -1;
+				}
+				rv = ec_motion_fifo_unpack(packed_buffer.data,
+					rv - sizeof(packed_buffer.number_data),
+					packed_buffer.number_data,
+					fifo_read_buffer.data,
+					ARRAY_SIZE(fifo_read_buffer.data));
+				if (rv < 0) {
+					fprintf(stderr,
+						"Bad packed fifo data.\n");
+					return -1;
+				}
+				fifo_read_buffer.number_data = rv;
+			} else {
+				rv = ec_command(EC_CMD_MOTION_SENSE_CMD, 2,
 					&param,
 					ms_command_sizes[param.cmd].outsize,
 					&fifo_read_buffer, ec_max_insize);
-			if (rv < 0)
-				return rv;
+				if (rv < 0)
+					return rv;
+			}
 
 			print_data += fifo_read_buffer.number_data;
 			for (i = 0; i < fifo_read_buffer.number_data; i++) {
@@ -7910,6 +7997,55 @@ cmd_battery_vendor_param_usage:
 	return -1;
 }
 
+int cmd_batch(int argc, char *argv[])
+{
+	struct ec_batch_cmd cmds[16];
+	uint8_t *in = ec_inbuf;
+	int count = argc - 1;
+	char *e;
+	int i, j, rv;
+
+	if (count < 1 || count > ARRAY_SIZE(cmds)) {
+		fprintf(stderr, "Usage: %s <cmd>[.<ver>] ... (up to %d)\n",
+			argv[0], (int)ARRAY_SIZE(cmds));
+		return -1;
+	}
+
+	for (i = 0; i < count; i++) {
+		memset(&cmds[i], 0, sizeof(cmds[i]));
+		cmds[i].command = strtol(argv[i + 1], &e, 0);
+		if (e && *e == '.')
+			cmds[i].version = strtol(e + 1, &e, 0);
+		if ((e && *e) || cmds[i].command < 0 ||
+		    cmds[i].command > 0xffff) {
+			fprintf(stderr, "Bad command: %s\n", argv[i + 1]);
+			return -1;
+		}
+		/* Split ec_inbuf evenly between the commands */
+		cmds[i].insize = ec_max_insize / count;
+		cmds[i].indata = in + i * cmds[i].insize;
+	}
+
+	rv = ec_command_batch(cmds, count, 0);
+	if (rv < 0)
+		return rv;
+
+	for (i = 0; i < rv; i++) {
+		printf("Command 0x%04x.%d: result %d", cmds[i].command,
+		       cmds[i].version, cmds[i].result);
+		for (j = 0; j < cmds[i].resp_size; j++) {
+			if (!(j % 16))
+				printf("\n ");
+			printf(" %02x", ((uint8_t *)cmds[i].indata)[j]);
+		}
+		printf("\n");
+	}
+	if (rv < count)
+		printf("%d command(s) not run\n", count - rv);
+
+	return 0;
+}
+
 int cmd_board_version(int argc, char *argv[])
 {
 	struct ec_response_board_version response;
@@ -9784,6 +9920,7 @@ const struct command commands[] = {
 	{"apreset", cmd_apreset},
 	{"autofanctrl", cmd_thermal_auto_fan_ctrl},
 	{"backlight", cmd_lcd_backlight},
+	{"batch", cmd_batch},
 	{"battery", cmd_battery},
 	{"batterycutoff", cmd_battery_cut_off},
 	{"batteryparam", cmd_battery_vendor_param},
@@ -9831,6 +9968,7 @@ const struct command commands[] = {
 	{"gpioget", cmd_gpio_get},
 	{"gpioset", cmd_gpio_set},
 	{"hangdetect", cmd_hang_detect},
+	{"hcstats", cmd_hcstats},
 	{"hello", cmd_hello},
 	{"hibdelay", cmd_hibdelay},
 	{"hostsleepstate", cmd_hostsleepstate},